@@ -9,6 +9,7 @@
 #include <Engine/Component/Component.hpp>
 #include <Graphics/Material/MaterialPBR.hpp>
 #include <Physics/Collider/BoundingBoxCollider.hpp>
+#include <Physics/BVH/MeshBVH.hpp>
 
 
 
@@ -88,6 +89,9 @@ protected:
 	//The bounding box for the frustum computation.
 	BoundingBoxCollider frustumCollider;
 
+	//The triangle BVH for the raycasts, built on the first request.
+	MeshBVH* bvh = nullptr;
+
 	//Is the object is generated ?
 	bool generated = false;
 
@@ -132,6 +136,10 @@ public:
 		{
 			glDeleteBuffers(1, &this->data.EBO);
 		}
+		if (this->bvh != nullptr) {
+			delete this->bvh;
+			this->bvh = nullptr;
+		}
 	}
 
 	/// <summary>
@@ -139,6 +147,8 @@ public:
 	/// </summary>
 	void ComputeFrustumCollider() {
 		this->frustumCollider = BoundingBoxCollider(this->points);
+		//Only used for culling, raycasts and events, no contact response.
+		this->frustumCollider.SetTrigger(true);
 	}
 
 	/// <summary>
@@ -173,11 +183,7 @@ public:
 
 		if (this->faces.size() > 0)
 		{
-			std::vector<unsigned int> indices;
-			for (Face f : this->faces) {
-				std::vector<unsigned int> tmp = f.ToTriangleVector();
-				indices.insert(indices.end(), tmp.begin(), tmp.end());
-			}
+			std::vector<unsigned int> indices = GetTriangleIndices();
 			glGenBuffers(1, &this->data.EBO);
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->data.EBO);
 
@@ -251,6 +257,11 @@ public:
 
 		this->frustumCollider.Update(pts);
 
+		//The BVH is rebuilt on the next raycast.
+		if (this->bvh != nullptr) {
+			delete this->bvh;
+			this->bvh = nullptr;
+		}
 
 		glBindBuffer(GL_ARRAY_BUFFER, this->data.VBO[0]);
 		glBufferSubData(GL_ARRAY_BUFFER, 0, this->points.size() * sizeof(glm::vec3), &this->points[0]);
@@ -279,6 +290,39 @@ public:
 	std::vector<Face> GetFaces() {
 		return this->faces;
 	}
+
+	/// <summary>
+	/// Return if the model has faces, without copying them.
+	/// </summary>
+	/// <returns>If the face list is not empty</returns>
+	bool HasFaces() {
+		return !this->faces.empty();
+	}
+
+	/// <summary>
+	/// Return the faces of the model as a triangle index list (3 indices per triangle, quads are splitted).
+	/// </summary>
+	/// <returns>The triangle index list</returns>
+	std::vector<unsigned int> GetTriangleIndices() {
+		std::vector<unsigned int> indices;
+		indices.reserve(this->faces.size() * 6);
+		for (Face f : this->faces) {
+			std::vector<unsigned int> tmp = f.ToTriangleVector();
+			indices.insert(indices.end(), tmp.begin(), tmp.end());
+		}
+		return indices;
+	}
+
+	/// <summary>
+	/// Return the triangle BVH of the model, in local space. Built on the first call and kept until the points change.
+	/// </summary>
+	/// <returns>The BVH of the model</returns>
+	MeshBVH* GetBVH() {
+		if (this->bvh == nullptr) {
+			this->bvh = new MeshBVH(this->points, GetTriangleIndices());
+		}
+		return this->bvh;
+	}
 };
 
 #endif // !__MODEL_HPP__
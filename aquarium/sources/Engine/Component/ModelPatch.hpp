@@ -0,0 +1,111 @@
+#ifndef __MODEL_PATCH_HPP__
+#define __MODEL_PATCH_HPP__
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <string>
+#include <GLFW/glfw3.h>
+#include <Engine/Shader.hpp>
+#include <Engine/Component/Component.hpp>
+#include <Engine/Component/Model.hpp>
+#include <Graphics/Material/MaterialPBR.hpp>
+
+
+
+/// <summary>
+/// ModelPatch component, a coarse quad model drawn as patches of 4 vertices, subdivided on the GPU by the tesselation stages of its shader.
+/// The triangles of the Model are kept, for the shaders without tesselation.
+/// </summary>
+class ModelPatch : public Model {
+public:
+
+	/// <summary>
+	/// Graphics data of the patches, (Vertex Array sharing the Vertex Buffers of the Model, Element Buffer of 4 indices per patch)
+	/// </summary>
+	struct DataPatch
+	{
+		GLuint VAO, EBO;
+		size_t sizeEBO = 0;
+	};
+
+protected:
+	//The data of the patches.
+	DataPatch dataPatch;
+public:
+
+	/// <summary>
+	/// Constructor of the ModelPatch, every face must be a quad.
+	/// </summary>
+	/// <param name="pts">List of the points of the model.</param>
+	/// <param name="normals">List of the normals of the model.</param>
+	/// <param name="faces">List of the quad faces of the model, a patch each.</param>
+	/// <param name="uv">List of the uvs of the model.</param>
+	/// <param name="material">The material of the model.</param>
+	ModelPatch(std::vector<glm::vec3> pts, std::vector<glm::vec3> normals = std::vector<glm::vec3>(), std::vector<Face> faces = std::vector<Face>(), std::vector<glm::vec2> uv = std::vector<glm::vec2>(), IMaterial* material = new MaterialPBR())
+		:Model(pts, normals, faces, uv, material)
+	{
+		GeneratePatchBuffer();
+	}
+
+	/// <summary>
+	/// Destructor that automaticalle free the patch buffers.
+	/// </summary>
+	~ModelPatch()
+	{
+		glDeleteVertexArrays(1, &this->dataPatch.VAO);
+		glDeleteBuffers(1, &this->dataPatch.EBO);
+	}
+
+	/// <summary>
+	/// Generate the VAO and EBO of the patches, on the VBO of the Model.
+	/// </summary>
+	void GeneratePatchBuffer()
+	{
+		std::vector<unsigned int> indices;
+		indices.reserve(this->faces.size() * 4);
+		for (Face f : this->faces) {
+			if (f.quad) {
+				indices.insert(indices.end(), f.linkedPoints, f.linkedPoints + 4);
+			}
+		}
+
+		glGenVertexArrays(1, &this->dataPatch.VAO);
+		glBindVertexArray(this->dataPatch.VAO);
+
+		glEnableVertexAttribArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, this->data.VBO[0]);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+		if (this->normals.size() > 0)
+		{
+			glEnableVertexAttribArray(1);
+			glBindBuffer(GL_ARRAY_BUFFER, this->data.VBO[1]);
+			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+		}
+
+		if (this->uv.size() > 0) {
+			glEnableVertexAttribArray(2);
+			glBindBuffer(GL_ARRAY_BUFFER, this->data.VBO[2]);
+			glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+		}
+
+		glGenBuffers(1, &this->dataPatch.EBO);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->dataPatch.EBO);
+		if (indices.size() > 0) {
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+		}
+		this->dataPatch.sizeEBO = indices.size();
+
+		glBindVertexArray(0);
+	}
+
+	/// <summary>
+	/// Return the graphicals data of the patches.
+	/// </summary>
+	/// <returns>The graphicals data.</returns>
+	DataPatch GetDataPatch() {
+		return this->dataPatch;
+	}
+};
+
+#endif // !__MODEL_PATCH_HPP__
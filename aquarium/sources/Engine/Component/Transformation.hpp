@@ -1,6 +1,7 @@
 #ifndef __TRANSFORMATION_HPP__
 #define __TRANSFORMATION_HPP__
 
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/transform.hpp>
@@ -28,6 +29,9 @@ private:
 
 	bool dirty = true;
 
+	//Incremented on each change of the transformation, to know if an object moved without comparing matrices.
+	uint64_t version = 1;
+
 public:
 
 	/// <summary>
@@ -72,6 +76,7 @@ public:
 	/// <returns>Self.</returns>
 	Transformation* SetPosition(glm::vec3 position) {
 		this->dirty = true;
+		this->version++;
 
 		this->position = position;
 		return this;
@@ -84,6 +89,7 @@ public:
 	/// <returns>Self.</returns>
 	Transformation* Translate(glm::vec3 translation) {
 		this->dirty = true;
+		this->version++;
 		glm::vec4 t = this->getMatrix() * glm::vec4(translation, 0);
 		this->position += glm::vec3(t.x, t.y, t.z);
 		return this;
@@ -96,6 +102,7 @@ public:
 	/// <returns>Self.</returns>
 	Transformation* SetRotation(glm::vec3 rotation) {
 		this->dirty = true;
+		this->version++;
 		this->rotation = rotation;
 		return this;
 	}
@@ -107,6 +114,7 @@ public:
 	/// <returns>Self.</returns>
 	Transformation* Rotate(glm::vec3 rotation) {
 		this->dirty = true;
+		this->version++;
 		this->rotation += rotation;
 		return this;
 	}
@@ -118,6 +126,7 @@ public:
 	/// <returns>Self.</returns>
 	Transformation* SetScale(glm::vec3 scale) {
 		this->dirty = true;
+		this->version++;
 		this->scale = scale;
 		return this;
 	}
@@ -129,6 +138,7 @@ public:
 	/// <returns>Self.</returns>
 	Transformation* SetScale(double scale) {
 		this->dirty = true;
+		this->version++;
 		this->scale = glm::vec3(scale);
 		return this;
 	}
@@ -141,10 +151,27 @@ public:
 	/// <returns>Self.</returns>
 	Transformation* Scale(double scale) {
 		this->dirty = true;
+		this->version++;
 		this->scale += glm::vec3(scale);
 		return this;
 	}
 
+	/// <summary>
+	/// Mark the transformation as changed, without changing it (e.g. the parent of the object changed).
+	/// </summary>
+	void Invalidate() {
+		this->dirty = true;
+		this->version++;
+	}
+
+	/// <summary>
+	/// Return the version of the transformation, changed each time the transformation is edited.
+	/// </summary>
+	/// <returns>The version</returns>
+	uint64_t GetVersion() {
+		return this->version;
+	}
+
 	/// <summary>
 	/// Return the position.
 	/// </summary>
@@ -31,9 +31,9 @@ protected:
 	bool active = true;
 
 	//The layer as 8bit value.
-	uint_fast8_t layer;
+	uint_fast8_t layer = 0;
 	//The tag as 8bit value.
-	uint_fast8_t tag;
+	uint_fast8_t tag = 0;
 
 public:
 	/// <summary>
@@ -204,6 +204,7 @@ public:
 	/// <param name="parent">The new parent.</param>
 	void setParent(GameObject* parent) {
 		this->parent = parent;
+		this->transform.Invalidate();
 	}
 
 	/// <summary>
@@ -450,6 +451,18 @@ public:
 		return this->transform.getRotationMatrix();
 	}
 
+	/// <summary>
+	/// Return the sum of the transformation versions of the gameobject and its parents, changed if the gameobject or one of its parents moved.
+	/// </summary>
+	/// <returns>The recursive version</returns>
+	uint64_t GetTransformVersionRecursive() {
+		uint64_t version = 0;
+		for (GameObject* g = this; g != NULL; g = g->parent) {
+			version += g->transform.GetVersion();
+		}
+		return version;
+	}
+
 	/// <summary>
 	/// Get the position of the Gameobject, using the global Transformation Matrix (GetMatrixRecursive()).
 	/// </summary>
@@ -492,6 +505,14 @@ public:
 		return this->layer;
 	}
 
+	/// <summary>
+	/// Change the layer of the Gameobject, used by the physics to filter the collisions (0 to 31).
+	/// </summary>
+	/// <param name="layer">The new layer</param>
+	void SetLayer(uint_fast8_t layer) {
+		this->layer = layer;
+	}
+
 	/// <summary>
 	/// Return the tag information.
 	/// </summary>
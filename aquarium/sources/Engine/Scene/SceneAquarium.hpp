@@ -39,6 +39,9 @@ public:
 		IMaterial* pipeMaterial = (new MaterialPBR())->SetFolderData("Pipe", "png");
 
 		IMaterial* waterMaterial = new MaterialPBR(glm::vec4(0.0, 0.66, 0.8, 0.7), 0.5f, 0.0f, 1.33f, true);
+		//The water surface is tesselated on the GPU, and shaded by the PBR fragment shader.
+		settedStdShaders.AddShader("Water/surface", new Shader("Water/surface.vert", "pbr.frag", "Water/surface.tess.control", "Water/surface.tess.eval"));
+		waterMaterial->SetShader("Water/surface");
 		IMaterial* glassMaterial = new MaterialPBR(glm::vec4(1, 1, 1, 0.1), 0.0f, 0.0f, 1.5f, true);
 		IMaterial* baseAquariumMaterial = new MaterialPBR(glm::vec4(1, 0, 1, 1.0));
 		IMaterial* ballMaterial = new MaterialPBR(glm::vec4(0.0, 1.0, 0.0, 1.0));
@@ -105,11 +108,16 @@ public:
 
 		//Create Water of the aquarium, with the water physics.
 		GameObject* water = new GameObject("water", aquarium);
-		Model* waterModel = ModelGenerator::CubeWater(waterMaterial, 1024, 512, glm::vec3(8, 3, 4));
+		ModelPatch* waterModel = ModelGenerator::PatchWater(waterMaterial, 32, 16, glm::vec3(8, 3, 4));
 		water->addComponent(new Displayable(10)); //cutom display priority, to show the water behind the glass.
 		water->addComponent(waterModel);
 		water->addComponent(new BoundingBoxCollider(waterModel->GetPoints()));
 		WaterPhysics* waterP = new WaterPhysics(512,256, glm::vec2(8,4));
+		//Height and velocity only, the normals are derived by the shaders.
+		waterP->SetCompactState(true);
+		//The caustics at twice the water resolution, updated every other frame.
+		waterP->SetCausticsQuality(WaterPhysics::CAUSTICS_HIGH);
+		waterP->SetCausticsInterval(2);
 		water->addComponent(waterP);
 		water->addComponent(new RaycastObject());
 		water->GetTransform()->SetPosition(glm::vec3(0, 2.55,0));
@@ -131,7 +139,9 @@ public:
 		ModelInstanced* fishR = ModelGenerator::QuadInstanced(fishBankMaterial, 2, 2, 0.25f, 0.25f);
 		fishRandom->addComponent(new Displayable(100));
 		fishRandom->addComponent(fishR);
-		fishRandom->addComponent(new FishRandom(fishR, glm::vec3(7,2.5,3.5), glm::vec3(0,-0.5,0)));
+		FishRandom* school = new FishRandom(fishR, glm::vec3(7,2.5,3.5), glm::vec3(0,-0.5,0));
+		school->SetBoidsMode(true);
+		fishRandom->addComponent(school);
 
 		bottomAquarium->addComponent(new ReceiveCaustics());
 		//Change the aquarium position.
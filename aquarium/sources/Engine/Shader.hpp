@@ -22,7 +22,8 @@ public:
 		FRAGMENT,
 		TESS_CONTROL,
 		TESS_EVAL,
-		GEOMETRY
+		GEOMETRY,
+		COMPUTE
 	};
 
 	/// <summary>
@@ -42,12 +43,12 @@ protected:
 
 	std::string shaderFolder = "assets/Shaders/";
 	std::string name;
-	std::string vertexFilename, fragmentFilename, tesselationControlFilename, tesselationEvalFilename, geometryFilename; // Name of all shader files, even if it does not exist, to permit the reload in case of change / add / remove
-	std::string vertexData, fragmentData, tesselationControlData, tesselationEvalData, geometryData; // data of each shaders
+	std::string vertexFilename, fragmentFilename, tesselationControlFilename, tesselationEvalFilename, geometryFilename, computeFilename; // Name of all shader files, even if it does not exist, to permit the reload in case of change / add / remove
+	std::string vertexData, fragmentData, tesselationControlData, tesselationEvalData, geometryData, computeData; // data of each shaders
 
 	std::vector<DataOverride> previousDataOverride; //List of all Overrides set for this shaders.
 
-	GLuint vertexShader, fragmentShader, tesselationControlShader, tesselationEvalShader, geometryShader; //Shaders
+	GLuint vertexShader = 0, fragmentShader = 0, tesselationControlShader = 0, tesselationEvalShader = 0, geometryShader = 0, computeShader = 0; //Shaders
 	GLuint program; // the program.
 public:
 
@@ -76,17 +77,28 @@ public:
 	/// <param name="tesselationControlFilename">The Tesselation Control shader file name.</param>
 	/// <param name="tesselationEvalFilename">The tesselation Evaluation shader file name.</param>
 	/// <param name="geometryFilename">The Geometry shader file name.</param>
-	Shader(std::string vertexFilename, std::string fragmentFilename, std::string tesselationControlFilename = "", std::string tesselationEvalFilename = "", std::string geometryFilename = "") {
-		this->name = vertexFilename + "," + fragmentFilename + "," + tesselationControlFilename + "," + tesselationEvalFilename + "," + geometryFilename;
+	/// <param name="computeFilename">The Compute shader file name, alone in its program.</param>
+	Shader(std::string vertexFilename, std::string fragmentFilename, std::string tesselationControlFilename = "", std::string tesselationEvalFilename = "", std::string geometryFilename = "", std::string computeFilename = "") {
+		this->name = vertexFilename + "," + fragmentFilename + "," + tesselationControlFilename + "," + tesselationEvalFilename + "," + geometryFilename + "," + computeFilename;
 		this->vertexFilename = vertexFilename;
 		this->fragmentFilename = fragmentFilename;
 		this->tesselationControlFilename = tesselationControlFilename;
 		this->tesselationEvalFilename = tesselationEvalFilename;
 		this->geometryFilename = geometryFilename;
+		this->computeFilename = computeFilename;
 		LoadFiles();
 		Compile();
 	}
 
+	/// <summary>
+	/// Generate a compute shader with its file (one.comp). A compute program can not have other stages.
+	/// </summary>
+	/// <param name="computeFilename">The compute shader file name.</param>
+	/// <returns>The shader</returns>
+	static Shader* Compute(std::string computeFilename) {
+		return new Shader("", "", "", "", "", computeFilename);
+	}
+
 	/// <summary>
 	/// Destroy the shader, and delete the program on GPU.
 	/// </summary>
@@ -177,6 +189,9 @@ public:
 				case GEOMETRY:
 					this->geometryData = ReplaceDefine(this->geometryData, d.define, d.value);
 					break;
+				case COMPUTE:
+					this->computeData = ReplaceDefine(this->computeData, d.define, d.value);
+					break;
 				}
 			}
 		}
@@ -194,6 +209,14 @@ public:
 	GLuint GetProgram() {
 		return program;
 	}
+
+	/// <summary>
+	/// Return if the program has tesselation stages, and so draws patches.
+	/// </summary>
+	/// <returns>If there is a tesselation evaluation shader</returns>
+	bool HasTesselation() {
+		return this->tesselationEvalData.size() > 0;
+	}
 protected:
 	/// <summary>
 	/// Replace a definition of a shader data.
@@ -221,22 +244,46 @@ protected:
 		return data;
 	}
 
+	/// <summary>
+	/// Replace each line #include "file" of a shader data by the content of the file, relative to the shader folder.
+	/// GLSL has no include, the snippets shared by several shaders (as Physics/normal.glsl) are pasted here before the compilation.
+	/// </summary>
+	/// <param name="data">The data of the shader</param>
+	/// <returns>The new Shader data</returns>
+	std::string IncludeFiles(std::string data) {
+		std::string search = "#include \"";
+		size_t found = data.find(search);
+		while (found != std::string::npos) {
+			size_t start = found + search.size();
+			size_t end = data.find('"', start);
+			if (end == std::string::npos) {
+				break;
+			}
+			std::string content = Tools::GetFileContent(this->shaderFolder + data.substr(start, end - start));
+			data = data.replace(found, end + 1 - found, content);
+			found = data.find(search, found + content.size());
+		}
+		return data;
+	}
+
 	/// <summary>
 	/// Load all shaders data.
 	/// </summary>
 	void LoadFiles()
 	{
-		this->vertexData = Tools::GetFileContent(this->shaderFolder + this->vertexFilename);
-		this->fragmentData = Tools::GetFileContent(this->shaderFolder + this->fragmentFilename);
-		this->tesselationControlData = Tools::GetFileContent(this->shaderFolder + this->tesselationControlFilename);
-		this->tesselationEvalData = Tools::GetFileContent(this->shaderFolder + this->tesselationEvalFilename);
-		this->geometryData = Tools::GetFileContent(this->shaderFolder + this->geometryFilename);
+		this->vertexData = IncludeFiles(Tools::GetFileContent(this->shaderFolder + this->vertexFilename));
+		this->fragmentData = IncludeFiles(Tools::GetFileContent(this->shaderFolder + this->fragmentFilename));
+		this->tesselationControlData = IncludeFiles(Tools::GetFileContent(this->shaderFolder + this->tesselationControlFilename));
+		this->tesselationEvalData = IncludeFiles(Tools::GetFileContent(this->shaderFolder + this->tesselationEvalFilename));
+		this->geometryData = IncludeFiles(Tools::GetFileContent(this->shaderFolder + this->geometryFilename));
+		this->computeData = IncludeFiles(Tools::GetFileContent(this->shaderFolder + this->computeFilename));
 		if (global.debug_shader) {
 			printf("VertexData : %s\n", vertexData.c_str());
 			printf("fragmentData : %s\n", fragmentData.c_str());
 			printf("tesselationControlData : %s\n", tesselationControlData.c_str());
 			printf("tesselationEvalData : %s\n", tesselationEvalData.c_str());
 			printf("geometryData : %s\n", geometryData.c_str());
+			printf("computeData : %s\n", computeData.c_str());
 		}
 	}
 
@@ -304,6 +351,18 @@ protected:
 			}
 		}
 
+		//compute
+		if (this->computeData.size() > 0) {
+			this->computeShader = glCreateShader(GL_COMPUTE_SHADER);
+			const char* cData = this->computeData.c_str();
+			glShaderSource(this->computeShader, 1, &cData, NULL);
+			glCompileShader(this->computeShader);
+
+			if (CheckIfCompiled(this->computeShader, "compute", this->computeFilename)) {
+				glAttachShader(this->program, this->computeShader);
+			}
+		}
+
 		glLinkProgram(this->program);
 
 		if (CheckIfLinked(this->name)) {
@@ -377,6 +436,7 @@ protected:
 			glDeleteShader(tesselationControlShader);
 			glDeleteShader(tesselationEvalShader);
 			glDeleteShader(geometryShader);
+			glDeleteShader(computeShader);
 
 			return false;
 		}
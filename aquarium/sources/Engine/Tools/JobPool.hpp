@@ -0,0 +1,192 @@
+#ifndef __JOB_POOL_HPP__
+#define __JOB_POOL_HPP__
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+/// <summary>
+/// A pool of worker threads executing jobs, used to split the CPU work of the engine (physics, simulation) across the cores.
+/// </summary>
+class JobPool
+{
+protected:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobs;
+
+	std::mutex mutex;
+	std::condition_variable jobAvailable;
+	std::condition_variable jobsDone;
+
+	//Number of jobs pushed and not finished yet.
+	size_t pending = 0;
+	bool stopping = false;
+
+	/// <summary>
+	/// The chunks of a ParallelFor, shared with its jobs: every thread claim the next chunk until none is left,
+	/// and the caller wait for this batch only, not for the other jobs of the pool.
+	/// </summary>
+	struct Batch {
+		std::atomic<size_t> next = { 0 };
+		size_t done = 0;
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+
+public:
+
+	/// <summary>
+	/// Create a pool of worker threads.
+	/// </summary>
+	/// <param name="nbThreads">Number of workers, 0 to use the number of cores minus the calling thread.</param>
+	JobPool(size_t nbThreads = 0) {
+		if (nbThreads == 0) {
+			unsigned int cores = std::thread::hardware_concurrency();
+			nbThreads = cores > 1 ? cores - 1 : 1;
+		}
+		for (size_t i = 0; i < nbThreads; i++) {
+			this->workers.push_back(std::thread([this]() { WorkerLoop(); }));
+		}
+	}
+
+	/// <summary>
+	/// Destructor, finish the remaining jobs then join the workers.
+	/// </summary>
+	~JobPool() {
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->stopping = true;
+		}
+		this->jobAvailable.notify_all();
+		for (std::thread& t : this->workers) {
+			t.join();
+		}
+	}
+
+	/// <summary>
+	/// Return the shared pool of the engine.
+	/// </summary>
+	/// <returns>The shared pool</returns>
+	static JobPool* Main() {
+		static JobPool pool;
+		return &pool;
+	}
+
+	/// <summary>
+	/// Return the number of threads that can execute jobs (workers and calling thread).
+	/// </summary>
+	/// <returns>The number of threads</returns>
+	size_t GetNbThreads() {
+		return this->workers.size() + 1;
+	}
+
+	/// <summary>
+	/// Add a job to the pool.
+	/// </summary>
+	/// <param name="job">The job</param>
+	void Push(std::function<void()> job) {
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->jobs.push_back(job);
+			this->pending++;
+		}
+		this->jobAvailable.notify_one();
+	}
+
+	/// <summary>
+	/// Wait for every pushed job, the calling thread execute jobs while waiting.
+	/// </summary>
+	void Wait() {
+		std::unique_lock<std::mutex> lock(this->mutex);
+		while (this->pending > 0) {
+			if (!this->jobs.empty()) {
+				std::function<void()> job = this->jobs.front();
+				this->jobs.pop_front();
+				lock.unlock();
+				job();
+				lock.lock();
+				this->pending--;
+			}
+			else {
+				this->jobsDone.wait(lock, [this]() { return this->pending == 0 || !this->jobs.empty(); });
+			}
+		}
+		this->jobsDone.notify_all();
+	}
+
+	/// <summary>
+	/// Split [0, count) in chunks and call func(begin, end) for each chunk across the threads, return when every chunk is done.
+	/// The calling thread run chunks too and only wait for the chunks of this call, so a ParallelFor can be called from a job,
+	/// and the other jobs of the pool do not delay it.
+	/// </summary>
+	/// <param name="count">The number of elements</param>
+	/// <param name="chunkSize">The number of elements of a chunk, 0 for one chunk per thread</param>
+	/// <param name="func">The function (size_t begin, size_t end)</param>
+	template<class Func>
+	void ParallelFor(size_t count, size_t chunkSize, Func func) {
+		if (count == 0) {
+			return;
+		}
+		if (chunkSize == 0) {
+			chunkSize = (count + GetNbThreads() - 1) / GetNbThreads();
+		}
+		if (chunkSize >= count) {
+			func((size_t)0, count);
+			return;
+		}
+		size_t nbChunks = (count + chunkSize - 1) / chunkSize;
+		std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+
+		//func is only called for a claimed chunk, so a helper running after the return does not use it.
+		auto run = [batch, &func, count, chunkSize, nbChunks]() {
+			size_t c;
+			while ((c = batch->next++) < nbChunks) {
+				size_t begin = c * chunkSize;
+				func(begin, std::min(count, begin + chunkSize));
+				std::unique_lock<std::mutex> lock(batch->mutex);
+				if (++batch->done == nbChunks) {
+					batch->finished.notify_all();
+				}
+			}
+		};
+		for (size_t i = 0, helpers = std::min(nbChunks - 1, this->workers.size()); i < helpers; i++) {
+			Push(run);
+		}
+		run();
+
+		std::unique_lock<std::mutex> lock(batch->mutex);
+		batch->finished.wait(lock, [&batch, nbChunks]() { return batch->done == nbChunks; });
+	}
+
+protected:
+
+	/// <summary>
+	/// Loop of a worker, execute the jobs until the pool is destroyed.
+	/// </summary>
+	void WorkerLoop() {
+		std::unique_lock<std::mutex> lock(this->mutex);
+		while (true) {
+			this->jobAvailable.wait(lock, [this]() { return this->stopping || !this->jobs.empty(); });
+			if (this->jobs.empty()) {
+				return;
+			}
+			std::function<void()> job = this->jobs.front();
+			this->jobs.pop_front();
+			lock.unlock();
+			job();
+			lock.lock();
+			this->pending--;
+			if (this->pending == 0) {
+				this->jobsDone.notify_all();
+			}
+		}
+	}
+};
+
+#endif // !__JOB_POOL_HPP__
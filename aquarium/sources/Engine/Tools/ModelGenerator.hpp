@@ -3,6 +3,7 @@
 
 #include <Engine/Component/Model.hpp>
 #include <Engine/Component/ModelInstanced.hpp>
+#include <Engine/Component/ModelPatch.hpp>
 #include <Graphics/Material/IMaterial.hpp>
 #include <Engine/Tools/Tools.hpp>
 #include <ofbx.h>
@@ -453,13 +454,53 @@ public:
 	/// <param name="center">Is the origin is centered ?</param>
 	/// <returns>The generated model.</returns>
 	static Model* CubeWater(IMaterial* material = new MaterialPBR(), int resX = 2, int resZ = 2, glm::vec3 size = glm::vec3(1.0f), bool center = true) {
-		if (resX < 1 || resZ < 1) {
+		std::vector<glm::vec3> pts;
+		std::vector<glm::vec3> normals;
+		std::vector<glm::vec2> uv;
+		std::vector<Model::Face> faces;
+		if (!CubeWaterData(pts, normals, uv, faces, resX, resZ, size, center)) {
 			return nullptr;
 		}
+		return new Model(pts, normals, faces, uv, material);
+	}
+
+	/// <summary>
+	/// Generate a Cube for the water simulation, as coarse patches subdivided on the GPU (see Water/surface shaders).
+	/// The number of vertices drawn follows the screen size of the patches, not the resolution of the simulation.
+	/// </summary>
+	/// <param name="material">The material, with a tesselation shader</param>
+	/// <param name="patchX">Number of patches on X of the top quad.</param>
+	/// <param name="patchZ">Number of patches on Z of the top quad.</param>
+	/// <param name="size">The size of each axis.</param>
+	/// <param name="center">Is the origin is centered ?</param>
+	/// <returns>The generated model.</returns>
+	static ModelPatch* PatchWater(IMaterial* material = new MaterialPBR(), int patchX = 16, int patchZ = 16, glm::vec3 size = glm::vec3(1.0f), bool center = true) {
 		std::vector<glm::vec3> pts;
 		std::vector<glm::vec3> normals;
 		std::vector<glm::vec2> uv;
 		std::vector<Model::Face> faces;
+		if (!CubeWaterData(pts, normals, uv, faces, patchX, patchZ, size, center)) {
+			return nullptr;
+		}
+		return new ModelPatch(pts, normals, faces, uv, material);
+	}
+
+	/// <summary>
+	/// Generate the data of a Cube for the water simulation, a grid of quads on the top and the walls under its borders.
+	/// </summary>
+	/// <param name="pts">The points (output)</param>
+	/// <param name="normals">The normals (output), (0, 1, 0) on the top</param>
+	/// <param name="uv">The uvs (output)</param>
+	/// <param name="faces">The quad faces (output)</param>
+	/// <param name="resX">Resolution X of the top quad.</param>
+	/// <param name="resZ">Resolution Z of the top quad.</param>
+	/// <param name="size">The size of each axis.</param>
+	/// <param name="center">Is the origin is centered ?</param>
+	/// <returns>If the data was generated.</returns>
+	static bool CubeWaterData(std::vector<glm::vec3>& pts, std::vector<glm::vec3>& normals, std::vector<glm::vec2>& uv, std::vector<Model::Face>& faces, int resX = 2, int resZ = 2, glm::vec3 size = glm::vec3(1.0f), bool center = true) {
+		if (resX < 1 || resZ < 1) {
+			return false;
+		}
 
 		double pasX = 1.0 / (double)resX;
 		double pasZ = 1.0 / (double)resZ;
@@ -558,7 +599,7 @@ public:
 			pts[i] *= size;
 		}
 
-		return new Model(pts, normals, faces, uv, material);
+		return true;
 	}
 
 
@@ -0,0 +1,99 @@
+#ifndef __SIMD_HPP__
+#define __SIMD_HPP__
+
+#include <cmath>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SIMD_AVX
+#define SIMD_ENABLED
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_SSE
+#define SIMD_ENABLED
+#endif
+
+/// <summary>
+/// Scalar lane, same interface as SimdLane to write a kernel once and run it on the remaining elements or without SIMD. The masks are 0.0 or 1.0.
+/// </summary>
+struct SimdScalar {
+	typedef float Reg;
+	static const int WIDTH = 1;
+	static Reg Load(const float* p) { return *p; }
+	static void Store(float* p, Reg a) { *p = a; }
+	static Reg Set(float v) { return v; }
+	static Reg Add(Reg a, Reg b) { return a + b; }
+	static Reg Sub(Reg a, Reg b) { return a - b; }
+	static Reg Mul(Reg a, Reg b) { return a * b; }
+	static Reg Div(Reg a, Reg b) { return a / b; }
+	static Reg Sqrt(Reg a) { return sqrtf(a); }
+	static Reg Min(Reg a, Reg b) { return a < b ? a : b; }
+	static Reg Max(Reg a, Reg b) { return a > b ? a : b; }
+	static Reg Abs(Reg a) { return fabsf(a); }
+	static Reg Le(Reg a, Reg b) { return a <= b ? 1.0f : 0.0f; }
+	static Reg Lt(Reg a, Reg b) { return a < b ? 1.0f : 0.0f; }
+	static Reg Gt(Reg a, Reg b) { return a > b ? 1.0f : 0.0f; }
+	static Reg And(Reg a, Reg b) { return a * b; }
+	static Reg Or(Reg a, Reg b) { return a + b > 0.0f ? 1.0f : 0.0f; }
+	static Reg Not(Reg a) { return 1.0f - a; }
+	static Reg Select(Reg mask, Reg a, Reg b) { return mask != 0.0f ? a : b; }
+	static int Mask(Reg a) { return a != 0.0f ? 1 : 0; }
+};
+
+#if defined(SIMD_AVX)
+/// <summary>
+/// AVX lane, 8 floats.
+/// </summary>
+struct SimdLane {
+	typedef __m256 Reg;
+	static const int WIDTH = 8;
+	static Reg Load(const float* p) { return _mm256_loadu_ps(p); }
+	static void Store(float* p, Reg a) { _mm256_storeu_ps(p, a); }
+	static Reg Set(float v) { return _mm256_set1_ps(v); }
+	static Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+	static Reg Sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+	static Reg Mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+	static Reg Div(Reg a, Reg b) { return _mm256_div_ps(a, b); }
+	static Reg Sqrt(Reg a) { return _mm256_sqrt_ps(a); }
+	static Reg Min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+	static Reg Max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+	static Reg Abs(Reg a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+	static Reg Le(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+	static Reg Lt(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static Reg Gt(Reg a, Reg b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	static Reg And(Reg a, Reg b) { return _mm256_and_ps(a, b); }
+	static Reg Or(Reg a, Reg b) { return _mm256_or_ps(a, b); }
+	static Reg Not(Reg a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+	static Reg Select(Reg mask, Reg a, Reg b) { return _mm256_blendv_ps(b, a, mask); }
+	static int Mask(Reg a) { return _mm256_movemask_ps(a); }
+};
+#elif defined(SIMD_SSE)
+/// <summary>
+/// SSE2 lane, 4 floats.
+/// </summary>
+struct SimdLane {
+	typedef __m128 Reg;
+	static const int WIDTH = 4;
+	static Reg Load(const float* p) { return _mm_loadu_ps(p); }
+	static void Store(float* p, Reg a) { _mm_storeu_ps(p, a); }
+	static Reg Set(float v) { return _mm_set1_ps(v); }
+	static Reg Add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+	static Reg Sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+	static Reg Mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+	static Reg Div(Reg a, Reg b) { return _mm_div_ps(a, b); }
+	static Reg Sqrt(Reg a) { return _mm_sqrt_ps(a); }
+	static Reg Min(Reg a, Reg b) { return _mm_min_ps(a, b); }
+	static Reg Max(Reg a, Reg b) { return _mm_max_ps(a, b); }
+	static Reg Abs(Reg a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+	static Reg Le(Reg a, Reg b) { return _mm_cmple_ps(a, b); }
+	static Reg Lt(Reg a, Reg b) { return _mm_cmplt_ps(a, b); }
+	static Reg Gt(Reg a, Reg b) { return _mm_cmpgt_ps(a, b); }
+	static Reg And(Reg a, Reg b) { return _mm_and_ps(a, b); }
+	static Reg Or(Reg a, Reg b) { return _mm_or_ps(a, b); }
+	static Reg Not(Reg a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+	static Reg Select(Reg mask, Reg a, Reg b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	static int Mask(Reg a) { return _mm_movemask_ps(a); }
+};
+#endif
+
+#endif // !__SIMD_HPP__
@@ -1,6 +1,7 @@
 #ifndef __FRAMEBUFFER_HPP__
 #define __FRAMEBUFFER_HPP__
 
+#include <vector>
 #include <glm/glm.hpp>
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
@@ -8,82 +9,91 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 
+/// <summary>
+/// Description of the attachments of a Framebuffer: only what the pass writes is allocated.
+/// </summary>
+struct RenderTargetDesc
+{
+	/// <summary>
+	/// The depth attachment.
+	/// </summary>
+	enum Depth {
+		DEPTH_NONE,
+		DEPTH_BUFFER, // a renderbuffer, for the depth test only
+		DEPTH_TEXTURE // a texture, that can be sampled
+	};
+
+	std::vector<GLint> colors; // the internal format of each color attachment, in order (GL_COLOR_ATTACHMENT0 + i)
+	Depth depth = DEPTH_NONE;
+	GLint filter = GL_LINEAR; // the filter of the textures
+
+	/// <summary>
+	/// The targets of the pbr render of a camera: color, position, normal and reflection, with a depth buffer.
+	/// </summary>
+	/// <param name="floating">Is the color floating point ?</param>
+	/// <returns>The description</returns>
+	static RenderTargetDesc GBuffer(bool floating = false) {
+		RenderTargetDesc desc;
+		desc.colors = { floating ? GL_RGBA16F : GL_RGBA, GL_RGBA16F, GL_RGBA16F, GL_RGBA16F };
+		desc.depth = DEPTH_BUFFER;
+		return desc;
+	}
+
+	/// <summary>
+	/// A single color target, for the passes writing one output.
+	/// </summary>
+	/// <param name="format">The internal format of the color</param>
+	/// <param name="depth">The depth attachment</param>
+	/// <returns>The description</returns>
+	static RenderTargetDesc Color(GLint format, Depth depth = DEPTH_NONE) {
+		RenderTargetDesc desc;
+		desc.colors = { format };
+		desc.depth = depth;
+		return desc;
+	}
+};
+
 /// <summary>
 /// Framebuffer object, with framebuffer and renderbuffer. Permit to do more advanced Graphical operations.
+/// The attachments are given by a RenderTargetDesc, the G-buffer of a camera by default.
 /// </summary>
 class Framebuffer
 {
 protected:
-	GLuint framebuffer;
-	GLuint renderbuffer;
-	GLuint tex_color;
-	GLuint tex_position;
-	GLuint tex_normal;
-	GLuint tex_reflection;
-	GLuint tex_depth;
+	GLuint framebuffer = 0;
+	GLuint renderbuffer = 0;
+	std::vector<GLuint> tex_colors; // the color attachments, in order
+	GLuint tex_depth = 0;
 
 	int w = -1, h = -1;
-	bool floating = false;
+	RenderTargetDesc desc;
 
 	/// <summary>
-	/// Generate Framebuffer textures.
+	/// Generate a texture of the framebuffer.
 	/// </summary>
-	void GenTextures(){
-
-		// create a Color attachment texture
-		glGenTextures(1, &this->tex_color);
-		glBindTexture(GL_TEXTURE_2D, this->tex_color);
-		glTexImage2D(GL_TEXTURE_2D, 0, floating ? GL_RGBA16F : GL_RGBA, this->w, this->h, 0, GL_RGBA, GL_FLOAT, NULL);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		// create a Normal attachment texture
-		glGenTextures(1, &this->tex_position);
-		glBindTexture(GL_TEXTURE_2D, this->tex_position);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, this->w, this->h, 0, GL_RGBA, GL_FLOAT, NULL);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	/// <param name="internalFormat">The internal format</param>
+	/// <param name="format">The format of the (empty) data</param>
+	/// <returns>The texture</returns>
+	GLuint GenTexture(GLint internalFormat, GLenum format) {
+		GLuint tex;
+		glGenTextures(1, &tex);
+		glBindTexture(GL_TEXTURE_2D, tex);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, this->w, this->h, 0, format, GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->desc.filter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->desc.filter);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 		glBindTexture(GL_TEXTURE_2D, 0);
+		return tex;
+	}
 
-		// create a Normal attachment texture
-		glGenTextures(1, &this->tex_normal);
-		glBindTexture(GL_TEXTURE_2D, this->tex_normal);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, this->w, this->h, 0, GL_RGBA, GL_FLOAT, NULL);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		// create a Reflection attachment texture
-		glGenTextures(1, &this->tex_reflection);
-		glBindTexture(GL_TEXTURE_2D, this->tex_reflection);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, this->w, this->h, 0, GL_RGBA, GL_FLOAT, NULL);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		// create a depth attachment texture
-		glGenTextures(1, &this->tex_depth);
-		glBindTexture(GL_TEXTURE_2D, this->tex_depth);
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, this->w, this->h, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_TEXTURE_MODE, GL_INTENSITY); // GL_INTENSITY16 ?
-		//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_R_TO_TEXTURE);
-		//glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
-		glBindTexture(GL_TEXTURE_2D, 0);
+	/// <summary>
+	/// Return the texture of a color attachment.
+	/// </summary>
+	/// <param name="i">The index of the attachment</param>
+	/// <returns>The texture, 0 if the framebuffer has no such attachment</returns>
+	GLuint GetTexAttachment(size_t i) {
+		return i < this->tex_colors.size() ? this->tex_colors[i] : 0;
 	}
 public:
 	/// <summary>
@@ -97,25 +107,48 @@ public:
 	/// Destroy the framebuffer, and free the GPU data.
 	/// </summary>
 	~Framebuffer() {
+		Release();
+	}
+
+	/// <summary>
+	/// Free the GPU data, the framebuffer can be generated again.
+	/// </summary>
+	void Release() {
 		glDeleteRenderbuffers(1, &this->renderbuffer);
 		glDeleteFramebuffers(1, &this->framebuffer);
-		glDeleteTextures(1, &this->tex_color);
-		glDeleteTextures(1, &this->tex_position);
-		glDeleteTextures(1, &this->tex_normal);
-		glDeleteTextures(1, &this->tex_reflection);
+		if (!this->tex_colors.empty()) {
+			glDeleteTextures((GLsizei)this->tex_colors.size(), this->tex_colors.data());
+		}
+		glDeleteTextures(1, &this->tex_depth);
+		this->renderbuffer = this->framebuffer = 0;
+		this->tex_colors.clear();
+		this->tex_depth = 0;
 	}
 
 	/// <summary>
-	/// Generate the framebuffer.
+	/// Generate the framebuffer, with the G-buffer of a camera.
 	/// </summary>
 	/// <param name="width">The width (-1 = screen width)</param>
 	/// <param name="height">The height (-1 = screen height)</param>
 	/// <param name="floating">Is floating point ?</param>
 	void Generate(int width = -1, int height = -1, bool floating = false) {
+		Generate(width, height, RenderTargetDesc::GBuffer(floating));
+	}
+
+	/// <summary>
+	/// Generate the framebuffer, with only the attachments of the description.
+	/// </summary>
+	/// <param name="width">The width (-1 = screen width)</param>
+	/// <param name="height">The height (-1 = screen height)</param>
+	/// <param name="desc">The attachments</param>
+	void Generate(int width, int height, const RenderTargetDesc& desc) {
+		//Generated again, the previous data is freed.
+		Release();
+
 		//create the framebuffer
 		glGenFramebuffers(1, &this->framebuffer);
 
-		this->floating = floating;
+		this->desc = desc;
 		this->w = width;
 		this->h = height;
 
@@ -126,26 +159,35 @@ public:
 			this->h = global.screen_height;
 		}
 
-		GenTextures();
-
 		glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->tex_color, 0);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, this->tex_position, 0);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, this->tex_normal, 0);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, this->tex_reflection, 0);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, this->tex_depth, 0);
-
-		unsigned int attachments[4] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
-		glDrawBuffers(4, attachments);
-		//glFramebufferTexture2D(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, this->tex_stencil, 0);
 
-		//create the renderbuffer
-		glGenRenderbuffers(1, &this->renderbuffer);
-		glBindRenderbuffer(GL_RENDERBUFFER, this->renderbuffer);
+		std::vector<GLenum> attachments;
+		for (GLint format : desc.colors) {
+			GLenum attachment = GL_COLOR_ATTACHMENT0 + (GLenum)this->tex_colors.size();
+			this->tex_colors.push_back(GenTexture(format, GL_RGBA));
+			glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, this->tex_colors.back(), 0);
+			attachments.push_back(attachment);
+		}
+		if (attachments.empty()) {
+			glDrawBuffer(GL_NONE);
+		}
+		else {
+			glDrawBuffers((GLsizei)attachments.size(), attachments.data());
+		}
 
-		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, this->w, this->h);
-		glBindRenderbuffer(GL_RENDERBUFFER, 0);
-		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->renderbuffer);
+		if (desc.depth == RenderTargetDesc::DEPTH_TEXTURE) {
+			this->tex_depth = GenTexture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, this->tex_depth, 0);
+		}
+		else if (desc.depth == RenderTargetDesc::DEPTH_BUFFER) {
+			//create the renderbuffer
+			glGenRenderbuffers(1, &this->renderbuffer);
+			glBindRenderbuffer(GL_RENDERBUFFER, this->renderbuffer);
+
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, this->w, this->h);
+			glBindRenderbuffer(GL_RENDERBUFFER, 0);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->renderbuffer);
+		}
 
 		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 			printf("ERROR::FRAMEBUFFER:: Framebuffer is not complete!\n");
@@ -158,7 +200,7 @@ public:
 	/// </summary>
 	/// <returns>The color texture</returns>
 	GLuint GetTexColor() {
-		return this->tex_color;
+		return GetTexAttachment(0);
 	}
 
 	/// <summary>
@@ -166,7 +208,7 @@ public:
 	/// </summary>
 	/// <returns>The color texture</returns>
 	GLuint GetTexPosition() {
-		return this->tex_position;
+		return GetTexAttachment(1);
 	}
 
 
@@ -175,7 +217,7 @@ public:
 	/// </summary>
 	/// <returns>The color texture</returns>
 	GLuint GetTexNormal() {
-		return this->tex_normal;
+		return GetTexAttachment(2);
 	}
 
 	/// <summary>
@@ -183,13 +225,13 @@ public:
 	/// </summary>
 	/// <returns>The color texture</returns>
 	GLuint GetTexReflection() {
-		return this->tex_reflection;
+		return GetTexAttachment(3);
 	}
 
 	/// <summary>
 	/// Return the depth texture.
 	/// </summary>
-	/// <returns>The depth texture</returns>
+	/// <returns>The depth texture, 0 without DEPTH_TEXTURE</returns>
 	GLuint GetTexDepth() {
 		return this->tex_depth;
 	}
@@ -223,15 +265,16 @@ public:
 		if (w <= 0 || h <= 0)
 			return;
 		
-		glBindTexture(GL_TEXTURE_2D, tex == 0 ? this->tex_color : this->tex_depth);
+		glBindTexture(GL_TEXTURE_2D, tex == 0 ? GetTexColor() : this->tex_depth);
 
-		if (floating) {
+		GLint format = this->desc.colors.empty() ? GL_RGBA : this->desc.colors[0];
+		if (format != GL_RGBA && format != GL_RGBA8) {
 			GLsizei stride = 4 * this->w;
 			std::vector<GLfloat> datas(stride*this->h);
 			glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, datas.data());
-			std::vector <GLchar> datasChar;
-			for (int i = 0, max = datas.size(); i < max; i++) {
-				datasChar.push_back((char)(datas[i] * 255.0));
+			std::vector <GLchar> datasChar(datas.size());
+			for (size_t i = 0, max = datas.size(); i < max; i++) {
+				datasChar[i] = (char)(datas[i] * 255.0);
 			}
 			stbi_write_png(name.c_str(), w, h, 4, datasChar.data(), stride);
 		}
@@ -243,6 +286,7 @@ public:
 
 
 			stbi_write_png(name.c_str(), w, h, 4, datas, stride);
+			delete[] datas;
 		}
 	}
 
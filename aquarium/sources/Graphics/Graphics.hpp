@@ -11,6 +11,7 @@
 #include <Graphics/Light.hpp>
 #include <Engine/Shader.hpp>
 #include <Engine/Component/Model.hpp>
+#include <Engine/Component/ModelPatch.hpp>
 #include <Engine/Tools/ModelGenerator.hpp>
 #include <Engine/Global.hpp>
 #include <Physics/GLPhysics/WaterPhysics.hpp>
@@ -178,6 +179,9 @@ public:
 				int useCaustics = 1;
 				glActiveTexture(GL_TEXTURE10);
 				glBindTexture(GL_TEXTURE_2D, wp->GetCaustics());
+				glActiveTexture(GL_TEXTURE11);
+				glBindTexture(GL_TEXTURE_2D, wp->GetCausticsPrevious());
+				glUniform1f(glGetUniformLocation(renderMaterial->GetShader()->GetProgram(), "u_caustics_blend"), wp->GetCausticsBlend());
 			}
 		}
 
@@ -192,12 +196,19 @@ public:
 
 
 		ModelInstanced* instanced = element->attachment->getFirstComponentByType<ModelInstanced>();
+		ModelPatch* patch = element->attachment->getFirstComponentByType<ModelPatch>();
 		if (instanced != nullptr) {
 			ModelInstanced::DataInstanced mData = instanced->GetDataInstanced();
 
 			glBindVertexArray(mData.VAO);
 			glDrawElementsInstanced(GL_TRIANGLES, mData.sizeEBO, GL_UNSIGNED_INT, 0, instanced->GetPositions().size());
 		}
+		else if (patch != nullptr && renderMaterial->GetShader()->HasTesselation()) {
+			//The patches are subdivided on the GPU, by the tesselation stages of the shader.
+			ModelPatch::DataPatch pData = patch->GetDataPatch();
+			glBindVertexArray(pData.VAO);
+			glDrawElements(GL_PATCHES, pData.sizeEBO, GL_UNSIGNED_INT, 0);
+		}
 		else {
 			Model::Data mData = model->GetData();
 			glBindVertexArray(mData.VAO);
@@ -60,6 +60,7 @@ public:
 		glUniformMatrix4fv(glGetUniformLocation(program, "u_projection"), 1, GL_FALSE, &P[0][0]);
 		glUniform3f(glGetUniformLocation(program, "u_cameraPos"), camPos.x, camPos.y, camPos.z);
 		glUniform1i(glGetUniformLocation(program, ("u_in_water")), inWater ? 1 : 0);
+		glUniform2f(glGetUniformLocation(program, "u_viewport"), (float)global.screen_width, (float)global.screen_height);
 
 	}
 
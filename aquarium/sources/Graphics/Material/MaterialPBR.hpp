@@ -283,6 +283,7 @@ public:
 		glUniform1i(glGetUniformLocation(program, ("t_pre_position")), 8);
 		glUniform1i(glGetUniformLocation(program, ("t_pre_normal")), 9);
 		glUniform1i(glGetUniformLocation(program, ("t_caustics")), 10);
+		glUniform1i(glGetUniformLocation(program, ("t_caustics_previous")), 11);
 
 		glActiveTexture(GL_TEXTURE0);
 		this->data->albedoMap->Bind();
@@ -301,17 +302,20 @@ public:
 
 		GLPhysic* p = this->attachment->getFirstComponentByType<GLPhysic>();
 		int isDataP = 0;
+		int derivedNormals = 0;
 		if (p != nullptr) {
 			if (p->GetTexture() != -1) {
 				glActiveTexture(GL_TEXTURE6);
 				glBindTexture(GL_TEXTURE_2D, p->GetTexture());
 				isDataP = 1;
+				derivedNormals = p->HasDerivedNormals() ? 1 : 0;
 			}
 		}
 
 
 
 		glUniform1i(glGetUniformLocation(program, ("u_is_data_physics")), isDataP);
+		glUniform1i(glGetUniformLocation(program, ("u_physics_derived_normals")), derivedNormals);
 		glUniform1i(glGetUniformLocation(program, ("u_use_pre_render")), mainRender ? 1 : 0);
 		glUniform1i(glGetUniformLocation(program, ("u_use_caustics")), causticAffected ? 1 : 0);
 
@@ -0,0 +1,118 @@
+#ifndef __PING_PONG_BUFFER_HPP__
+#define __PING_PONG_BUFFER_HPP__
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <Graphics/Framebuffer.hpp>
+
+/// <summary>
+/// Two floating point state textures, each with its own single attachment framebuffer (RenderTargetDesc::Color).
+/// A pass reads the read texture and renders into the other one, then the two are swapped: the result is read in place by the next pass, without copy.
+/// </summary>
+class PingPongBuffer
+{
+protected:
+	Framebuffer targets[2];
+
+	//Index of the texture holding the current state.
+	int read = 0;
+
+	int w = -1, h = -1;
+
+public:
+	/// <summary>
+	/// Create a ping pong buffer.
+	/// </summary>
+	PingPongBuffer() {
+
+	}
+
+	/// <summary>
+	/// Generate the two state textures and their framebuffers.
+	/// </summary>
+	/// <param name="width">The width</param>
+	/// <param name="height">The height</param>
+	/// <param name="data">The initial state (RGBA floats), nullptr for undefined</param>
+	/// <param name="internalFormat">The format of the textures</param>
+	void Generate(int width, int height, const float* data = nullptr, GLint internalFormat = GL_RGBA16F) {
+		this->w = width;
+		this->h = height;
+		this->read = 0;
+
+		//Generated again, the previous targets are freed.
+		for (Framebuffer& target : this->targets) {
+			target.Generate(width, height, RenderTargetDesc::Color(internalFormat));
+			if (data != nullptr) {
+				glBindTexture(GL_TEXTURE_2D, target.GetTexColor());
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_FLOAT, data);
+			}
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	/// <summary>
+	/// Bind the framebuffer of the write texture, and its viewport.
+	/// </summary>
+	void BindWrite() {
+		glViewport(0, 0, this->w, this->h);
+		glBindFramebuffer(GL_FRAMEBUFFER, this->targets[1 - this->read].GetFramebuffer());
+	}
+
+	/// <summary>
+	/// Bind the framebuffer of the read texture, and its viewport, to modify the current state in place (e.g. additive blending).
+	/// </summary>
+	void BindRead() {
+		glViewport(0, 0, this->w, this->h);
+		glBindFramebuffer(GL_FRAMEBUFFER, this->targets[this->read].GetFramebuffer());
+	}
+
+	/// <summary>
+	/// Swap the textures, the written texture become the current state.
+	/// </summary>
+	void Swap() {
+		this->read = 1 - this->read;
+	}
+
+	/// <summary>
+	/// Return the texture holding the current state.
+	/// </summary>
+	/// <returns>The read texture</returns>
+	GLuint GetRead() {
+		return this->targets[this->read].GetTexColor();
+	}
+
+	/// <summary>
+	/// Return the texture written by the next pass.
+	/// </summary>
+	/// <returns>The write texture</returns>
+	GLuint GetWrite() {
+		return this->targets[1 - this->read].GetTexColor();
+	}
+
+	/// <summary>
+	/// Return the framebuffer of the texture written by the next pass.
+	/// </summary>
+	/// <returns>The write framebuffer</returns>
+	GLuint GetWriteFramebuffer() {
+		return this->targets[1 - this->read].GetFramebuffer();
+	}
+
+	/// <summary>
+	/// Return the width
+	/// </summary>
+	/// <returns>the width</returns>
+	int GetWidth() {
+		return this->w;
+	}
+
+	/// <summary>
+	/// return the height
+	/// </summary>
+	/// <returns>the height</returns>
+	int GetHeight() {
+		return this->h;
+	}
+};
+
+#endif // !__PING_PONG_BUFFER_HPP__
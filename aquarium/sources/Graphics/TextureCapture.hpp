@@ -0,0 +1,185 @@
+#ifndef __TEXTURE_CAPTURE_HPP__
+#define __TEXTURE_CAPTURE_HPP__
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <GL/glew.h>
+
+#include <Engine/Tools/JobPool.hpp>
+#include <Graphics/Framebuffer.hpp>
+
+/// <summary>
+/// Read textures back to the CPU without stalling the frame, e.g. to write them to PNG files.
+/// A read is copied to a pixel pack buffer of a ring with a fence, the buffer is mapped on a later frame once the fence is signaled,
+/// then given to its callback. For the files, the conversion and the PNG encoding are done on a worker thread of the shared JobPool.
+/// </summary>
+class TextureCapture
+{
+protected:
+	/// <summary>
+	/// A pixel pack buffer of the ring, and the capture it holds.
+	/// </summary>
+	struct Slot {
+		GLuint pbo = 0;
+		GLsync fence = 0;
+		bool busy = false;
+		size_t size = 0;
+		std::function<void(std::vector<unsigned char>&)> done;
+	};
+
+	std::vector<Slot> slots;
+	size_t next = 0; // the oldest slot, the next to be read
+
+	//The encoding run on the shared pool, a ParallelFor only wait for its own chunks.
+	JobPool* encoder = JobPool::Main();
+
+public:
+	/// <summary>
+	/// Create the capture ring.
+	/// </summary>
+	/// <param name="size">The number of captures in flight</param>
+	TextureCapture(int size = 4) {
+		this->slots.resize(std::max(size, 1));
+	}
+
+	/// <summary>
+	/// Destroy the capture ring, finish the captures in flight and free the buffers.
+	/// </summary>
+	~TextureCapture() {
+		Update(true);
+		for (Slot& s : this->slots) {
+			if (s.pbo != 0) {
+				glDeleteBuffers(1, &s.pbo);
+			}
+		}
+		this->encoder->Wait();
+	}
+
+	/// <summary>
+	/// Start the capture of a texture, written to a file on a later frame.
+	/// </summary>
+	/// <param name="texture">The texture</param>
+	/// <param name="w">The width of the texture</param>
+	/// <param name="h">The height of the texture</param>
+	/// <param name="floating">Is floating point ? (values in [0, 1] are written)</param>
+	/// <param name="name">The name of the file</param>
+	/// <returns>If the capture started, false if the ring is full</returns>
+	bool Request(GLuint texture, int w, int h, bool floating, std::string name) {
+		JobPool* encoder = this->encoder;
+		return Read(texture, 0, w, h, floating, [encoder, w, h, floating, name](std::vector<unsigned char>& data) {
+			std::shared_ptr<std::vector<unsigned char>> pixels = std::make_shared<std::vector<unsigned char>>(std::move(data));
+			encoder->Push([pixels, w, h, floating, name]() {
+				Encode(*pixels, w, h, floating, name);
+			});
+		}, name);
+	}
+
+	/// <summary>
+	/// Start the read of a texture level (RGBA), given to the callback on a later frame.
+	/// </summary>
+	/// <param name="texture">The texture</param>
+	/// <param name="level">The mipmap level</param>
+	/// <param name="w">The width of the level</param>
+	/// <param name="h">The height of the level</param>
+	/// <param name="floating">Read floats ? (else bytes)</param>
+	/// <param name="done">Called by Update with the pixels, row by row</param>
+	/// <param name="name">The name of the read, for the messages</param>
+	/// <returns>If the read started, false if the ring is full</returns>
+	bool Read(GLuint texture, int level, int w, int h, bool floating, std::function<void(std::vector<unsigned char>&)> done, std::string name = "") {
+		if (w <= 0 || h <= 0) {
+			return false;
+		}
+		Slot* slot = nullptr;
+		for (size_t i = 0, max = this->slots.size(); i < max && slot == nullptr; i++) {
+			Slot& s = this->slots[(this->next + i) % max];
+			if (!s.busy) {
+				slot = &s;
+			}
+		}
+		if (slot == nullptr) {
+			if (name.size() > 0) {
+				printf("Capture ring full, %s skipped.\n", name.c_str());
+			}
+			return false;
+		}
+
+		if (slot->pbo == 0) {
+			glGenBuffers(1, &slot->pbo);
+		}
+		size_t size = (size_t)w * (size_t)h * 4 * (floating ? sizeof(GLfloat) : sizeof(GLubyte));
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+		glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+
+		//Copy to the buffer on the GPU timeline, the call return without waiting.
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glGetTexImage(GL_TEXTURE_2D, level, GL_RGBA, floating ? GL_FLOAT : GL_UNSIGNED_BYTE, (void*)0);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		slot->busy = true;
+		slot->size = size;
+		slot->done = done;
+		return true;
+	}
+
+	/// <summary>
+	/// Read the captures whose copy is done, and give them to their callback. To call every frame.
+	/// </summary>
+	/// <param name="wait">Wait for every capture in flight (e.g. before destruction)</param>
+	void Update(bool wait = false) {
+		for (size_t i = 0, max = this->slots.size(); i < max; i++) {
+			Slot& s = this->slots[this->next];
+			if (!s.busy) {
+				break;
+			}
+			GLenum status = glClientWaitSync(s.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? GL_TIMEOUT_IGNORED : 0);
+			if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+				break; // In order, the next ones are not done either.
+			}
+			glDeleteSync(s.fence);
+			s.fence = 0;
+
+			std::vector<unsigned char> pixels(s.size);
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+			void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, s.size, GL_MAP_READ_BIT);
+			if (mapped != nullptr) {
+				memcpy(pixels.data(), mapped, s.size);
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			}
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+			std::function<void(std::vector<unsigned char>&)> done = std::move(s.done);
+			s.busy = false;
+			this->next = (this->next + 1) % max;
+			if (mapped != nullptr && done) {
+				done(pixels);
+			}
+		}
+	}
+
+protected:
+
+	/// <summary>
+	/// Convert the pixels to bytes if needed and write the PNG file, on the encoder thread.
+	/// </summary>
+	static void Encode(std::vector<unsigned char>& pixels, int w, int h, bool floating, const std::string& name) {
+		if (floating) {
+			const GLfloat* values = (const GLfloat*)pixels.data();
+			size_t count = (size_t)w * (size_t)h * 4;
+			std::vector<unsigned char> bytes(count);
+			for (size_t i = 0; i < count; i++) {
+				bytes[i] = (unsigned char)(std::min(std::max(values[i], 0.0f), 1.0f) * 255.0f);
+			}
+			stbi_write_png(name.c_str(), w, h, 4, bytes.data(), 4 * w);
+		}
+		else {
+			stbi_write_png(name.c_str(), w, h, 4, pixels.data(), 4 * w);
+		}
+	}
+};
+
+#endif // !__TEXTURE_CAPTURE_HPP__
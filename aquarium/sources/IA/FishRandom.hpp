@@ -2,17 +2,41 @@
 #define __FISH_RANDOM_HPP__
 
 #include <vector>
+#include <algorithm>
 #include <glm/glm.hpp>
 #include <glm/gtc/random.hpp>
 #include <Engine/Component/Component.hpp>
 #include <Engine/EngineBehavior.hpp>
 #include <Engine/Component/ModelInstanced.hpp>
+#include <Engine/Tools/JobPool.hpp>
 
 /// <summary>
 /// Fish Random system
+/// Each fish walk randomly, or in boids mode the fish school: separation, alignment, cohesion and avoidance of the bounds,
+/// the neighbours found in a uniform grid rebuilt each frame by counting sort.
 /// </summary>
 class FishRandom : public Component, public EngineBehavior
 {
+public:
+	/// <summary>
+	/// The distances and weights of the boids mode.
+	/// </summary>
+	struct BoidsSettings {
+		float neighbourRadius = 0.6f; // the distance under which a fish see another, the size of the cells of the grid
+		float separationRadius = 0.2f; // the distance under which a fish move away from another
+		float separation = 2.0f;
+		float alignment = 1.0f;
+		float cohesion = 0.6f;
+		float bounds = 4.0f; // the weight of the avoidance of the bounds
+		float boundsMargin = 0.4f; // the distance to the bounds where the fish start to turn
+		float speedMin = 0.3f; // per second
+		float speedMax = 0.8f; // per second
+		float steeringMax = 2.0f; // the maximum acceleration, per second squared
+		int neighboursMax = 24; // the neighbours averaged for the cohesion and the alignment of a fish
+
+		BoidsSettings() {}
+	};
+
 protected:
 
 	ModelInstanced* fish;
@@ -26,6 +50,26 @@ protected:
 	glm::vec3 halfSizeBound;
 	glm::vec3 center;
 	int number;
+
+	bool boids = false;
+	BoidsSettings boidsSettings;
+
+	//The uniform grid of the boids mode: the fish of the cell c are sorted[cellStart[c]] to sorted[cellStart[c + 1] - 1].
+	glm::vec3 gridMin;
+	float cellSize = 1.0f;
+	glm::ivec3 gridSize = glm::ivec3(1);
+	std::vector<int> cellOf; // the cell of each fish
+	std::vector<int> cellStart; // the first sorted fish of each cell, and the count at the end
+	std::vector<int> cellFill; // the insertion cursor of each cell during the sort
+	std::vector<int> sorted; // the fish, sorted by cell
+	std::vector<glm::vec3> sortedPoints; // the positions and velocities in the sorted order, contiguous per cell
+	std::vector<glm::vec3> sortedVelocities;
+	std::vector<glm::vec3> nextVelocities;
+
+	//Number of fish given to a thread for the steering.
+	size_t fishPerChunk = 128;
+
+	JobPool* pool = JobPool::Main();
 public:
 
 
@@ -72,7 +116,81 @@ public:
 	/// </summary>
 	/// <param name="deltaT"></param>
 	void loop(double deltaT) override {
-		UpdatePositions(deltaT);
+		if (this->boids) {
+			UpdateBoids(deltaT);
+		}
+		else {
+			UpdatePositions(deltaT);
+		}
+	}
+
+	/// <summary>
+	/// Make the fish school (boids), or walk randomly again.
+	/// </summary>
+	/// <param name="enabled">Use the boids mode ?</param>
+	/// <param name="settings">The distances and weights of the boids</param>
+	void SetBoidsMode(bool enabled, BoidsSettings settings = BoidsSettings()) {
+		this->boids = enabled;
+		this->boidsSettings = settings;
+		for (int i = 0; i < number; i++) {
+			if (enabled) {
+				//Per second in boids mode, a random heading at a random speed.
+				glm::vec3 direction = glm::sphericalRand(1.0f);
+				this->velocities[i] = direction * ValueBetween(settings.speedMin, settings.speedMax);
+			}
+			else {
+				//Pick a new random velocity on the next update.
+				this->timeBeforeChange[i] = -1;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Return if the boids mode is used.
+	/// </summary>
+	/// <returns>If the fish school</returns>
+	bool IsBoidsMode() {
+		return this->boids;
+	}
+
+	/// <summary>
+	/// Set the job pool splitting the steering of the boids.
+	/// </summary>
+	/// <param name="pool">The job pool, nullptr to compute on the calling thread</param>
+	void SetJobPool(JobPool* pool) {
+		this->pool = pool;
+	}
+
+	/// <summary>
+	/// Update the boids: rebuild the grid, steer every fish from its neighbours, then move them.
+	/// </summary>
+	/// <param name="deltaT">Time since last frame</param>
+	void UpdateBoids(double deltaT) {
+		//A long frame (loading, breakpoint) would throw the fish through the bounds.
+		float dt = (float)std::min(deltaT, 0.1);
+
+		BuildGrid();
+
+		size_t count = (size_t)this->number;
+		this->nextVelocities.resize(count);
+		if (this->pool != nullptr) {
+			this->pool->ParallelFor(count, this->fishPerChunk, [this, dt](size_t begin, size_t end) {
+				SteerRange(begin, end, dt);
+			});
+		}
+		else {
+			SteerRange(0, count, dt);
+		}
+
+		glm::vec3 min = this->center - this->halfSizeBound;
+		glm::vec3 max = this->center + this->halfSizeBound;
+		for (size_t i = 0; i < count; i++) {
+			this->velocities[i] = this->nextVelocities[i];
+			this->points[i] = glm::clamp(this->points[i] + this->velocities[i] * dt, min, max);
+		}
+
+		//Set for instanciation
+		this->fish->SetPositions(this->points);
 	}
 
 
@@ -109,6 +227,133 @@ public:
 		this->fish->SetPositions(this->points);
 	}
 
+protected:
+
+	/// <summary>
+	/// Rebuild the uniform grid over the bounds by counting sort, in O(n): count the fish per cell, the prefix sum give the start of each cell, then place the fish.
+	/// The cells are as large as the neighbour radius, so the neighbours of a fish are in the 27 cells around its own.
+	/// </summary>
+	void BuildGrid() {
+		size_t count = (size_t)this->number;
+		this->cellSize = std::max(this->boidsSettings.neighbourRadius, 0.01f);
+		this->gridMin = this->center - this->halfSizeBound;
+		this->gridSize = glm::max(glm::ivec3(glm::ceil(this->halfSizeBound * 2.0f / this->cellSize)), glm::ivec3(1));
+		size_t cells = (size_t)this->gridSize.x * (size_t)this->gridSize.y * (size_t)this->gridSize.z;
+
+		this->cellOf.resize(count);
+		this->cellStart.assign(cells + 1, 0);
+		for (size_t i = 0; i < count; i++) {
+			int c = CellIndex(CellCoord(this->points[i]));
+			this->cellOf[i] = c;
+			this->cellStart[c + 1]++;
+		}
+		for (size_t c = 0; c < cells; c++) {
+			this->cellStart[c + 1] += this->cellStart[c];
+		}
+
+		this->cellFill.assign(this->cellStart.begin(), this->cellStart.end() - 1);
+		this->sorted.resize(count);
+		this->sortedPoints.resize(count);
+		this->sortedVelocities.resize(count);
+		for (size_t i = 0; i < count; i++) {
+			int s = this->cellFill[this->cellOf[i]]++;
+			this->sorted[s] = (int)i;
+			this->sortedPoints[s] = this->points[i];
+			this->sortedVelocities[s] = this->velocities[i];
+		}
+	}
+
+	/// <summary>
+	/// Steer the sorted fish [begin, end) from their neighbours and the bounds, written to nextVelocities.
+	/// </summary>
+	void SteerRange(size_t begin, size_t end, float dt) {
+		const BoidsSettings& b = this->boidsSettings;
+		float radius2 = b.neighbourRadius * b.neighbourRadius;
+		float separation2 = b.separationRadius * b.separationRadius;
+		glm::vec3 min = this->center - this->halfSizeBound;
+		glm::vec3 max = this->center + this->halfSizeBound;
+		float margin = std::max(b.boundsMargin, 0.001f);
+
+		for (size_t s = begin; s < end; s++) {
+			glm::vec3 p = this->sortedPoints[s];
+			glm::vec3 v = this->sortedVelocities[s];
+			glm::ivec3 cell = CellCoord(p);
+			glm::ivec3 from = glm::max(cell - 1, glm::ivec3(0));
+			glm::ivec3 to = glm::min(cell + 1, this->gridSize - 1);
+
+			glm::vec3 away(0), sumPoints(0), sumVelocities(0);
+			int neighbours = 0;
+			for (int z = from.z; z <= to.z; z++) {
+				for (int y = from.y; y <= to.y; y++) {
+					//The cells of a row are contiguous in the sorted order.
+					int first = this->cellStart[CellIndex(glm::ivec3(from.x, y, z))];
+					int last = this->cellStart[CellIndex(glm::ivec3(to.x, y, z)) + 1];
+					for (int j = first; j < last; j++) {
+						glm::vec3 d = p - this->sortedPoints[j];
+						float d2 = glm::dot(d, d);
+						if (j == (int)s || d2 > radius2) {
+							continue;
+						}
+						//Every close fish is avoided, only the cohesion and the alignment are capped.
+						if (d2 < separation2 && d2 > 1e-8f) {
+							away += d / d2 * b.separationRadius;
+						}
+						if (neighbours < b.neighboursMax) {
+							neighbours++;
+							sumPoints += this->sortedPoints[j];
+							sumVelocities += this->sortedVelocities[j];
+						}
+					}
+				}
+			}
+
+			glm::vec3 steering = away * b.separation;
+			if (neighbours > 0) {
+				float inv = 1.0f / (float)neighbours;
+				steering += (sumVelocities * inv - v) * b.alignment;
+				steering += (sumPoints * inv - p) * b.cohesion;
+			}
+			for (int a = 0; a < 3; a++) {
+				if (p[a] < min[a] + margin) {
+					steering[a] += (min[a] + margin - p[a]) / margin * b.bounds;
+				}
+				else if (p[a] > max[a] - margin) {
+					steering[a] -= (p[a] - max[a] + margin) / margin * b.bounds;
+				}
+			}
+
+			float length = glm::length(steering);
+			if (length > b.steeringMax) {
+				steering *= b.steeringMax / length;
+			}
+			v += steering * dt;
+
+			float speed = glm::length(v);
+			if (speed < 1e-6f) {
+				v = glm::vec3(b.speedMin, 0, 0); // no rand() on the worker threads
+			}
+			else if (speed < b.speedMin || speed > b.speedMax) {
+				v *= glm::clamp(speed, b.speedMin, b.speedMax) / speed;
+			}
+			this->nextVelocities[this->sorted[s]] = v;
+		}
+	}
+
+	/// <summary>
+	/// Return the cell of a position, clamped to the grid.
+	/// </summary>
+	glm::ivec3 CellCoord(glm::vec3 p) {
+		glm::ivec3 c = glm::ivec3(glm::floor((p - this->gridMin) / this->cellSize));
+		return glm::clamp(c, glm::ivec3(0), this->gridSize - 1);
+	}
+
+	/// <summary>
+	/// Return the index of a cell, x first.
+	/// </summary>
+	int CellIndex(glm::ivec3 c) {
+		return (c.z * this->gridSize.y + c.y) * this->gridSize.x + c.x;
+	}
+
 private :
 	float ValueBetween(glm::vec2 minmax) {
 		return ValueBetween(minmax.x, minmax.y);
@@ -0,0 +1,576 @@
+#ifndef __MESH_BVH_HPP__
+#define __MESH_BVH_HPP__
+
+#include <vector>
+#include <cstdint>
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include <Engine/Tools/Simd.hpp>
+
+/// <summary>
+/// Triangle Bounding Volume Hierarchy of a mesh, in the local space of the mesh.
+/// Built once with a binned SAH, stored as a flattened (depth first) node array with skip links for a stackless traversal.
+/// Rays can traverse it alone, or by packets of PACKET_SIZE coherent rays sharing the node tests (SIMD slab tests).
+/// </summary>
+class MeshBVH
+{
+public:
+	/// <summary>
+	/// A node of the flattened BVH.
+	/// The left child of an inner node is always the next node, and "skip" is the index of the first node after its subtree.
+	/// </summary>
+	struct Node {
+		glm::vec3 min;
+		int32_t skip;
+		glm::vec3 max;
+		int32_t first; // first triangle of a leaf
+		int32_t count; // number of triangles of a leaf (0 for an inner node)
+	};
+
+	/// <summary>
+	/// Result of a raycast against the BVH.
+	/// </summary>
+	struct Hit {
+		/// <param name="hit">If the ray hit a triangle.</param>
+		/// <param name="triangle">The index of the hitted triangle, in the index list given at the build.</param>
+		/// <param name="distance">The ray parameter of the hit.</param>
+		/// <param name="barycentric">The barycentric coordinates of the hit (weights of the 3 points of the triangle).</param>
+		bool hit = false;
+		int triangle = -1;
+		float distance = FLT_MAX;
+		glm::vec3 barycentric = glm::vec3(0);
+	};
+
+	static const int PACKET_SIZE = 8;
+
+	/// <summary>
+	/// A packet of rays traversing the BVH together, stored in SoA for the SIMD slab tests.
+	/// The unused lanes have a negative max distance and never hit.
+	/// </summary>
+	struct RayPacket {
+		float ox[PACKET_SIZE], oy[PACKET_SIZE], oz[PACKET_SIZE];
+		float dx[PACKET_SIZE], dy[PACKET_SIZE], dz[PACKET_SIZE];
+		float ix[PACKET_SIZE], iy[PACKET_SIZE], iz[PACKET_SIZE];
+		float maxDistance[PACKET_SIZE];
+		int count = 0;
+
+		RayPacket() {
+			Clear();
+		}
+
+		/// <summary>
+		/// Remove every ray of the packet.
+		/// </summary>
+		void Clear() {
+			for (int i = 0; i < PACKET_SIZE; i++) {
+				ox[i] = oy[i] = oz[i] = dx[i] = dy[i] = dz[i] = 0.0f;
+				ix[i] = iy[i] = iz[i] = 1.0f;
+				maxDistance[i] = -1.0f;
+			}
+			count = 0;
+		}
+
+		/// <summary>
+		/// Add a ray to the packet, must not be full.
+		/// </summary>
+		/// <param name="origin">Origin of the ray</param>
+		/// <param name="direction">Direction of the ray</param>
+		/// <param name="distance">Maximum ray parameter to accept</param>
+		void Push(glm::vec3 origin, glm::vec3 direction, float distance = FLT_MAX) {
+			glm::vec3 inv = SafeInverse(direction);
+			ox[count] = origin.x; oy[count] = origin.y; oz[count] = origin.z;
+			dx[count] = direction.x; dy[count] = direction.y; dz[count] = direction.z;
+			ix[count] = inv.x; iy[count] = inv.y; iz[count] = inv.z;
+			maxDistance[count] = distance;
+			count++;
+		}
+
+		/// <summary>
+		/// Return if the packet is full.
+		/// </summary>
+		/// <returns>Is full ?</returns>
+		bool IsFull() const {
+			return count == PACKET_SIZE;
+		}
+
+		glm::vec3 GetOrigin(int i) const {
+			return glm::vec3(ox[i], oy[i], oz[i]);
+		}
+
+		glm::vec3 GetDirection(int i) const {
+			return glm::vec3(dx[i], dy[i], dz[i]);
+		}
+	};
+
+protected:
+	/// <summary>
+	/// Precomputed triangle for the Moller-Trumbore intersection.
+	/// </summary>
+	struct BVHTriangle {
+		glm::vec3 p0, e1, e2;
+		int index;
+	};
+
+	/// <summary>
+	/// Bin used by the SAH build.
+	/// </summary>
+	struct Bin {
+		glm::vec3 min = glm::vec3(FLT_MAX);
+		glm::vec3 max = glm::vec3(-FLT_MAX);
+		int count = 0;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<BVHTriangle> triangles;
+
+	//Index list of the mesh, 3 per triangle, to find the vertices of a hitted triangle.
+	std::vector<unsigned int> indices;
+
+	static const int NB_BINS = 12;
+	static const int MAX_LEAF_SIZE = 4;
+
+public:
+	/// <summary>
+	/// Create an empty BVH.
+	/// </summary>
+	MeshBVH() {}
+
+	/// <summary>
+	/// Build the BVH of a triangle mesh.
+	/// </summary>
+	/// <param name="points">The points of the mesh</param>
+	/// <param name="indices">The index list, 3 per triangle</param>
+	MeshBVH(const std::vector<glm::vec3>& points, const std::vector<unsigned int>& indices) {
+		Build(points, indices);
+	}
+
+	/// <summary>
+	/// Build (or rebuild) the BVH of a triangle mesh.
+	/// </summary>
+	/// <param name="points">The points of the mesh</param>
+	/// <param name="indices">The index list, 3 per triangle</param>
+	void Build(const std::vector<glm::vec3>& points, const std::vector<unsigned int>& indices) {
+		nodes.clear();
+		triangles.clear();
+		this->indices = indices;
+
+		size_t nbTriangles = indices.size() / 3;
+		if (nbTriangles == 0) {
+			return;
+		}
+
+		std::vector<glm::vec3> centroids(nbTriangles);
+		std::vector<glm::vec3> boxMin(nbTriangles);
+		std::vector<glm::vec3> boxMax(nbTriangles);
+		std::vector<int> order(nbTriangles);
+
+		for (size_t i = 0; i < nbTriangles; i++) {
+			glm::vec3 a = points[indices[i * 3]], b = points[indices[i * 3 + 1]], c = points[indices[i * 3 + 2]];
+			boxMin[i] = glm::min(a, glm::min(b, c));
+			boxMax[i] = glm::max(a, glm::max(b, c));
+			centroids[i] = (a + b + c) / 3.0f;
+			order[i] = (int)i;
+		}
+
+		nodes.reserve(nbTriangles * 2);
+		BuildRecursive(order, 0, (int)nbTriangles, centroids, boxMin, boxMax);
+
+		// Store the triangles in leaf order, so a leaf reads a contiguous range.
+		triangles.resize(nbTriangles);
+		for (size_t i = 0; i < nbTriangles; i++) {
+			int t = order[i];
+			glm::vec3 a = points[indices[t * 3]], b = points[indices[t * 3 + 1]], c = points[indices[t * 3 + 2]];
+			triangles[i].p0 = a;
+			triangles[i].e1 = b - a;
+			triangles[i].e2 = c - a;
+			triangles[i].index = t;
+		}
+	}
+
+	/// <summary>
+	/// Return if the BVH contain something.
+	/// </summary>
+	/// <returns>Is empty ?</returns>
+	bool IsEmpty() const {
+		return nodes.empty();
+	}
+
+	/// <summary>
+	/// Return the flattened node list.
+	/// </summary>
+	/// <returns>The node list</returns>
+	const std::vector<Node>& GetNodes() const {
+		return nodes;
+	}
+
+	/// <summary>
+	/// Return the bounds of the whole mesh.
+	/// </summary>
+	/// <param name="min">The min result</param>
+	/// <param name="max">The max result</param>
+	void GetBounds(glm::vec3& min, glm::vec3& max) const {
+		if (nodes.empty()) {
+			min = max = glm::vec3(0);
+			return;
+		}
+		min = nodes[0].min;
+		max = nodes[0].max;
+	}
+
+	/// <summary>
+	/// Send a ray in the BVH (in the local space of the mesh), stackless traversal.
+	/// </summary>
+	/// <param name="origin">Origin of the ray</param>
+	/// <param name="direction">Direction of the ray (does not need to be normalized, the distance is the ray parameter)</param>
+	/// <param name="maxDistance">Maximum ray parameter to accept</param>
+	/// <returns>The closest hit</returns>
+	Hit Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance = FLT_MAX) const {
+		Hit res;
+		res.distance = maxDistance;
+		if (nodes.empty()) {
+			res.distance = FLT_MAX;
+			return res;
+		}
+
+		glm::vec3 invDir = SafeInverse(direction);
+
+		int index = 0;
+		int end = (int)nodes.size();
+		while (index < end) {
+			const Node& n = nodes[index];
+			if (!RayBox(origin, invDir, n.min, n.max, res.distance)) {
+				index = n.skip;
+			}
+			else if (n.count > 0) {
+				for (int i = n.first, max = n.first + n.count; i < max; i++) {
+					IntersectTriangle(triangles[i], origin, direction, res);
+				}
+				index = n.skip;
+			}
+			else {
+				index++;
+			}
+		}
+
+		if (!res.hit) {
+			res.distance = FLT_MAX;
+		}
+		return res;
+	}
+
+	/// <summary>
+	/// Send a packet of rays in the BVH (in the local space of the mesh), a node is entered if any ray of the packet hit it.
+	/// </summary>
+	/// <param name="packet">The rays, their max distance is shortened by the hits</param>
+	/// <param name="hits">The closest hit of each ray of the packet (packet.count results)</param>
+	void RaycastPacket(RayPacket& packet, Hit* hits) const {
+		for (int i = 0; i < packet.count; i++) {
+			hits[i] = Hit();
+			hits[i].distance = packet.maxDistance[i];
+		}
+
+		int active = (1 << packet.count) - 1;
+		int index = 0;
+		int end = (int)nodes.size();
+		while (index < end) {
+			const Node& n = nodes[index];
+			int mask = PacketBox(packet, n.min, n.max) & active;
+			if (mask == 0) {
+				index = n.skip;
+			}
+			else if (n.count > 0) {
+				for (int r = 0; r < packet.count; r++) {
+					if ((mask & (1 << r)) == 0) {
+						continue;
+					}
+					glm::vec3 origin = packet.GetOrigin(r);
+					glm::vec3 direction = packet.GetDirection(r);
+					for (int i = n.first, max = n.first + n.count; i < max; i++) {
+						if (IntersectTriangle(triangles[i], origin, direction, hits[r])) {
+							packet.maxDistance[r] = hits[r].distance;
+						}
+					}
+				}
+				index = n.skip;
+			}
+			else {
+				index++;
+			}
+		}
+
+		for (int i = 0; i < packet.count; i++) {
+			if (!hits[i].hit) {
+				hits[i].distance = FLT_MAX;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Return the vertex of a hitted triangle nearest to the hit, the one with the biggest barycentric weight.
+	/// </summary>
+	/// <param name="hit">The hit</param>
+	/// <returns>The index of the vertex in the mesh, -1 if nothing was hitted</returns>
+	int GetNearestVertex(const Hit& hit) const {
+		if (!hit.hit) {
+			return -1;
+		}
+		int corner = 0;
+		if (hit.barycentric[1] > hit.barycentric[corner]) corner = 1;
+		if (hit.barycentric[2] > hit.barycentric[corner]) corner = 2;
+		return (int)this->indices[hit.triangle * 3 + corner];
+	}
+
+	/// <summary>
+	/// Slab test of every ray of a packet with a box.
+	/// </summary>
+	/// <param name="packet">The rays</param>
+	/// <param name="min">Min of the box</param>
+	/// <param name="max">Max of the box</param>
+	/// <param name="tNear">Ray parameter where each ray enter the box (0 if inside), can be nullptr</param>
+	/// <returns>Bit mask of the rays hitting the box before their max distance</returns>
+	static int PacketBox(const RayPacket& packet, glm::vec3 min, glm::vec3 max, float* tNear = nullptr) {
+#if defined(SIMD_ENABLED)
+		return PacketBox(SimdLane(), packet, min, max, tNear);
+#else
+		return PacketBox(SimdScalar(), packet, min, max, tNear);
+#endif
+	}
+
+	/// <summary>
+	/// Ray / Box slab test, with the inverse direction of the ray.
+	/// </summary>
+	/// <param name="origin">Origin of the ray</param>
+	/// <param name="invDir">Inverse of the direction of the ray</param>
+	/// <param name="min">Min of the box</param>
+	/// <param name="max">Max of the box</param>
+	/// <param name="maxDistance">Maximum ray parameter to accept</param>
+	/// <returns>Is the ray hitting the box before maxDistance ?</returns>
+	static bool RayBox(glm::vec3 origin, glm::vec3 invDir, glm::vec3 min, glm::vec3 max, float maxDistance) {
+		glm::vec3 t0 = (min - origin) * invDir;
+		glm::vec3 t1 = (max - origin) * invDir;
+		glm::vec3 tNear = glm::min(t0, t1);
+		glm::vec3 tFar = glm::max(t0, t1);
+		float tmin = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+		float tmax = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+		return tmin <= tmax;
+	}
+
+	/// <summary>
+	/// Compute the inverse of a direction, avoiding division by zero.
+	/// </summary>
+	/// <param name="direction">The direction</param>
+	/// <returns>The inverse direction</returns>
+	static glm::vec3 SafeInverse(glm::vec3 direction) {
+		glm::vec3 res;
+		for (int i = 0; i < 3; i++) {
+			float d = direction[i];
+			if (fabsf(d) < 1e-12f) {
+				d = d < 0.0f ? -1e-12f : 1e-12f;
+			}
+			res[i] = 1.0f / d;
+		}
+		return res;
+	}
+
+protected:
+	/// <summary>
+	/// Slab test of the packet, Ops::WIDTH rays at a time.
+	/// </summary>
+	template<class Ops>
+	static int PacketBox(Ops, const RayPacket& p, glm::vec3 min, glm::vec3 max, float* tNear) {
+		typedef typename Ops::Reg Reg;
+		int mask = 0;
+		for (int l = 0; l < PACKET_SIZE; l += Ops::WIDTH) {
+			Reg t0x = Ops::Mul(Ops::Sub(Ops::Set(min.x), Ops::Load(p.ox + l)), Ops::Load(p.ix + l));
+			Reg t1x = Ops::Mul(Ops::Sub(Ops::Set(max.x), Ops::Load(p.ox + l)), Ops::Load(p.ix + l));
+			Reg t0y = Ops::Mul(Ops::Sub(Ops::Set(min.y), Ops::Load(p.oy + l)), Ops::Load(p.iy + l));
+			Reg t1y = Ops::Mul(Ops::Sub(Ops::Set(max.y), Ops::Load(p.oy + l)), Ops::Load(p.iy + l));
+			Reg t0z = Ops::Mul(Ops::Sub(Ops::Set(min.z), Ops::Load(p.oz + l)), Ops::Load(p.iz + l));
+			Reg t1z = Ops::Mul(Ops::Sub(Ops::Set(max.z), Ops::Load(p.oz + l)), Ops::Load(p.iz + l));
+
+			Reg tmin = Ops::Max(Ops::Max(Ops::Min(t0x, t1x), Ops::Min(t0y, t1y)), Ops::Max(Ops::Min(t0z, t1z), Ops::Set(0.0f)));
+			Reg tmax = Ops::Min(Ops::Min(Ops::Max(t0x, t1x), Ops::Max(t0y, t1y)), Ops::Min(Ops::Max(t0z, t1z), Ops::Load(p.maxDistance + l)));
+			if (tNear != nullptr) {
+				Ops::Store(tNear + l, tmin);
+			}
+			mask |= Ops::Mask(Ops::Le(tmin, tmax)) << l;
+		}
+		return mask;
+	}
+
+	/// <summary>
+	/// Moller-Trumbore intersection, update the hit if closer.
+	/// </summary>
+	/// <param name="t">The triangle</param>
+	/// <param name="origin">Origin of the ray</param>
+	/// <param name="direction">Direction of the ray</param>
+	/// <param name="hit">The current closest hit</param>
+	/// <returns>If the hit was updated</returns>
+	static bool IntersectTriangle(const BVHTriangle& t, glm::vec3 origin, glm::vec3 direction, Hit& hit) {
+		glm::vec3 p = glm::cross(direction, t.e2);
+		float det = glm::dot(t.e1, p);
+		if (fabsf(det) < 1e-12f) {
+			return false;
+		}
+		float invDet = 1.0f / det;
+		glm::vec3 s = origin - t.p0;
+		float u = glm::dot(s, p) * invDet;
+		if (u < 0.0f || u > 1.0f) {
+			return false;
+		}
+		glm::vec3 q = glm::cross(s, t.e1);
+		float v = glm::dot(direction, q) * invDet;
+		if (v < 0.0f || u + v > 1.0f) {
+			return false;
+		}
+		float d = glm::dot(t.e2, q) * invDet;
+		if (d < 0.0f || d >= hit.distance) {
+			return false;
+		}
+		hit.hit = true;
+		hit.distance = d;
+		hit.triangle = t.index;
+		hit.barycentric = glm::vec3(1.0f - u - v, u, v);
+		return true;
+	}
+
+	/// <summary>
+	/// Build the node for the range [start, end[ of the order list, and its childs, in depth first order.
+	/// </summary>
+	/// <returns>The index of the node</returns>
+	int BuildRecursive(std::vector<int>& order, int start, int end, const std::vector<glm::vec3>& centroids, const std::vector<glm::vec3>& boxMin, const std::vector<glm::vec3>& boxMax) {
+		int index = (int)nodes.size();
+		nodes.push_back(Node());
+
+		glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+		glm::vec3 cMin(FLT_MAX), cMax(-FLT_MAX);
+		for (int i = start; i < end; i++) {
+			int t = order[i];
+			min = glm::min(min, boxMin[t]);
+			max = glm::max(max, boxMax[t]);
+			cMin = glm::min(cMin, centroids[t]);
+			cMax = glm::max(cMax, centroids[t]);
+		}
+		nodes[index].min = min;
+		nodes[index].max = max;
+
+		int count = end - start;
+		int axis = -1;
+		int splitBin = -1;
+		if (count > MAX_LEAF_SIZE) {
+			FindSAHSplit(order, start, end, HalfArea(min, max, true), cMin, cMax, centroids, boxMin, boxMax, axis, splitBin);
+		}
+
+		int mid = -1;
+		if (axis >= 0) {
+			float scale = NB_BINS / (cMax[axis] - cMin[axis]);
+			float cmin = cMin[axis];
+			mid = (int)(std::partition(order.begin() + start, order.begin() + end, [&](int t) {
+				return BinIndex(centroids[t][axis], cmin, scale) <= splitBin;
+			}) - order.begin());
+		}
+		else if (count > MAX_LEAF_SIZE) {
+			// All centroids are on the same point or the SAH found no good split : median split on the largest axis.
+			glm::vec3 extent = cMax - cMin;
+			axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+			mid = start + count / 2;
+			std::nth_element(order.begin() + start, order.begin() + mid, order.begin() + end, [&](int a, int b) {
+				return centroids[a][axis] < centroids[b][axis];
+			});
+		}
+
+		if (mid <= start || mid >= end) {
+			nodes[index].first = start;
+			nodes[index].count = count;
+		}
+		else {
+			nodes[index].first = -1;
+			nodes[index].count = 0;
+			BuildRecursive(order, start, mid, centroids, boxMin, boxMax);
+			BuildRecursive(order, mid, end, centroids, boxMin, boxMax);
+		}
+		nodes[index].skip = (int)nodes.size();
+		return index;
+	}
+
+	/// <summary>
+	/// Find the best split with the Surface Area Heuristic, on binned centroids.
+	/// </summary>
+	/// <param name="parentArea">The half area of the node to split</param>
+	/// <param name="axis">The best axis (output, -1 if making a leaf is cheaper)</param>
+	/// <param name="splitBin">The last bin of the left side (output)</param>
+	void FindSAHSplit(const std::vector<int>& order, int start, int end, float parentArea, glm::vec3 cMin, glm::vec3 cMax, const std::vector<glm::vec3>& centroids, const std::vector<glm::vec3>& boxMin, const std::vector<glm::vec3>& boxMax, int& axis, int& splitBin) {
+		float bestCost = (float)(end - start); // cost of a leaf
+		axis = -1;
+		splitBin = -1;
+
+		for (int a = 0; a < 3; a++) {
+			float extent = cMax[a] - cMin[a];
+			if (extent <= 1e-12f) {
+				continue;
+			}
+			float scale = NB_BINS / extent;
+
+			Bin bins[NB_BINS];
+			for (int i = start; i < end; i++) {
+				int t = order[i];
+				Bin& b = bins[BinIndex(centroids[t][a], cMin[a], scale)];
+				b.count++;
+				b.min = glm::min(b.min, boxMin[t]);
+				b.max = glm::max(b.max, boxMax[t]);
+			}
+
+			// Sweep from the right to have the area and count of each right side.
+			float rightArea[NB_BINS];
+			int rightCount[NB_BINS];
+			glm::vec3 rMin(FLT_MAX), rMax(-FLT_MAX);
+			int rCount = 0;
+			for (int i = NB_BINS - 1; i > 0; i--) {
+				rMin = glm::min(rMin, bins[i].min);
+				rMax = glm::max(rMax, bins[i].max);
+				rCount += bins[i].count;
+				rightArea[i] = HalfArea(rMin, rMax);
+				rightCount[i] = rCount;
+			}
+
+			glm::vec3 lMin(FLT_MAX), lMax(-FLT_MAX);
+			int lCount = 0;
+			for (int i = 0; i < NB_BINS - 1; i++) {
+				lMin = glm::min(lMin, bins[i].min);
+				lMax = glm::max(lMax, bins[i].max);
+				lCount += bins[i].count;
+				if (lCount == 0 || rightCount[i + 1] == 0) {
+					continue;
+				}
+				float cost = 0.125f + (HalfArea(lMin, lMax) * lCount + rightArea[i + 1] * rightCount[i + 1]) / parentArea;
+				if (cost < bestCost) {
+					bestCost = cost;
+					axis = a;
+					splitBin = i;
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Return the bin of a centroid coordinate.
+	/// </summary>
+	static int BinIndex(float value, float min, float scale) {
+		int b = (int)((value - min) * scale);
+		return b < 0 ? 0 : (b >= NB_BINS ? NB_BINS - 1 : b);
+	}
+
+	/// <summary>
+	/// Return the half surface area of a box.
+	/// </summary>
+	static float HalfArea(glm::vec3 min, glm::vec3 max, bool nonZero = false) {
+		glm::vec3 e = glm::max(max - min, glm::vec3(0));
+		float a = e.x * e.y + e.y * e.z + e.z * e.x;
+		return (nonZero && a <= 0.0f) ? 1.0f : a;
+	}
+};
+
+#endif // !__MESH_BVH_HPP__
@@ -0,0 +1,299 @@
+#ifndef __BATCH_DETECTION_HPP__
+#define __BATCH_DETECTION_HPP__
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include <Engine/Tools/Simd.hpp>
+#include <Physics/Collider/BoundingBoxCollider.hpp>
+#include <Physics/Collider/SphereCollider.hpp>
+
+/// <summary>
+/// Batched narrowphase, test many pairs of colliders at once. Used by the PairCache as an early out: the pairs proved separated skip the exact test.
+/// The colliders are stored in SoA batches, the lane i of the batch A is tested against the lane i of the batch B.
+/// The pairs are tested 8 by 8 with AVX, 4 by 4 with SSE2, the remaining pairs (or all of them without SIMD) use the same kernel in scalar.
+/// </summary>
+class BatchDetection {
+public:
+
+	/// <summary>
+	/// A batch of spheres, in world space.
+	/// </summary>
+	struct SphereBatch {
+		std::vector<float> center[3];
+		std::vector<float> radius;
+
+		size_t Size() const {
+			return this->radius.size();
+		}
+
+		void Clear() {
+			for (int i = 0; i < 3; i++) {
+				this->center[i].clear();
+			}
+			this->radius.clear();
+		}
+
+		void Push(glm::vec3 c, float r) {
+			for (int i = 0; i < 3; i++) {
+				this->center[i].push_back(c[i]);
+			}
+			this->radius.push_back(r);
+		}
+
+		void Push(SphereCollider* collider) {
+			const SphereCollider::WorldCache& w = collider->GetWorld();
+			Push(w.center, w.radius);
+		}
+	};
+
+	/// <summary>
+	/// A batch of axis aligned bounding box.
+	/// </summary>
+	struct AABBBatch {
+		std::vector<float> min[3];
+		std::vector<float> max[3];
+
+		size_t Size() const {
+			return this->min[0].size();
+		}
+
+		void Clear() {
+			for (int i = 0; i < 3; i++) {
+				this->min[i].clear();
+				this->max[i].clear();
+			}
+		}
+
+		void Push(glm::vec3 mi, glm::vec3 ma) {
+			for (int i = 0; i < 3; i++) {
+				this->min[i].push_back(mi[i]);
+				this->max[i].push_back(ma[i]);
+			}
+		}
+	};
+
+	/// <summary>
+	/// A batch of oriented bounding box, in world space. axis[a * 3 + c] is the component c of the axis a.
+	/// </summary>
+	struct OBBBatch {
+		std::vector<float> center[3];
+		std::vector<float> axis[9];
+		std::vector<float> halfSize[3];
+
+		size_t Size() const {
+			return this->center[0].size();
+		}
+
+		void Clear() {
+			for (int i = 0; i < 3; i++) {
+				this->center[i].clear();
+				this->halfSize[i].clear();
+			}
+			for (int i = 0; i < 9; i++) {
+				this->axis[i].clear();
+			}
+		}
+
+		void Push(glm::vec3 c, glm::mat3 orientation, glm::vec3 half) {
+			for (int i = 0; i < 3; i++) {
+				this->center[i].push_back(c[i]);
+				this->halfSize[i].push_back(half[i]);
+				for (int j = 0; j < 3; j++) {
+					this->axis[i * 3 + j].push_back(orientation[i][j]);
+				}
+			}
+		}
+
+		void Push(BoundingBoxCollider* collider) {
+			const BoundingBoxCollider::WorldCache& w = collider->GetWorld();
+			Push(w.center, glm::mat3(w.axis[0], w.axis[1], w.axis[2]), w.halfSize);
+		}
+	};
+
+	/// <summary>
+	/// Return the number of pairs tested by one SIMD instruction (1 without SIMD).
+	/// </summary>
+	/// <returns>The number of lanes</returns>
+	static int Width() {
+#if defined(SIMD_ENABLED)
+		return SimdOps::WIDTH;
+#else
+		return 1;
+#endif
+	}
+
+	/// <summary>
+	/// Test the pairs of spheres (a[i], b[i]).
+	/// </summary>
+	/// <param name="a">First spheres</param>
+	/// <param name="b">Second spheres, same size as a</param>
+	/// <param name="result">1 if the pair collide, else 0 (output)</param>
+	static void SphereSphere(const SphereBatch& a, const SphereBatch& b, std::vector<uint8_t>& result) {
+		Run(a.Size(), result, [&](auto ops, size_t i) {
+			return SphereSphereKernel<decltype(ops)>(a, b, i);
+		});
+	}
+
+	/// <summary>
+	/// Test the pairs (sphere a[i], AABB b[i]).
+	/// </summary>
+	/// <param name="a">The spheres</param>
+	/// <param name="b">The AABB, same size as a</param>
+	/// <param name="result">1 if the pair collide, else 0 (output)</param>
+	static void SphereAABB(const SphereBatch& a, const AABBBatch& b, std::vector<uint8_t>& result) {
+		Run(a.Size(), result, [&](auto ops, size_t i) {
+			return SphereAABBKernel<decltype(ops)>(a, b, i);
+		});
+	}
+
+	/// <summary>
+	/// Test the pairs of AABB (a[i], b[i]).
+	/// </summary>
+	/// <param name="a">First AABB</param>
+	/// <param name="b">Second AABB, same size as a</param>
+	/// <param name="result">1 if the pair collide, else 0 (output)</param>
+	static void AABBAABB(const AABBBatch& a, const AABBBatch& b, std::vector<uint8_t>& result) {
+		Run(a.Size(), result, [&](auto ops, size_t i) {
+			return AABBAABBKernel<decltype(ops)>(a, b, i);
+		});
+	}
+
+	/// <summary>
+	/// Test the pairs of OBB (a[i], b[i]) with the 15 axis of the separating axis theorem.
+	/// </summary>
+	/// <param name="a">First OBB</param>
+	/// <param name="b">Second OBB, same size as a</param>
+	/// <param name="result">1 if the pair collide, else 0 (output)</param>
+	static void OBBOBB(const OBBBatch& a, const OBBBatch& b, std::vector<uint8_t>& result) {
+		Run(a.Size(), result, [&](auto ops, size_t i) {
+			return OBBOBBKernel<decltype(ops)>(a, b, i);
+		});
+	}
+
+protected:
+
+	typedef SimdScalar ScalarOps;
+#if defined(SIMD_ENABLED)
+	typedef SimdLane SimdOps;
+#endif
+
+	/// <summary>
+	/// Run a kernel on count pairs, SIMD lanes first then the scalar remainder.
+	/// </summary>
+	template<class Kernel>
+	static void Run(size_t count, std::vector<uint8_t>& result, Kernel kernel) {
+		result.resize(count);
+		size_t i = 0;
+#if defined(SIMD_ENABLED)
+		for (; i + SimdOps::WIDTH <= count; i += SimdOps::WIDTH) {
+			int mask = SimdOps::Mask(kernel(SimdOps(), i));
+			for (int l = 0; l < SimdOps::WIDTH; l++) {
+				result[i + l] = (uint8_t)((mask >> l) & 1);
+			}
+		}
+#endif
+		for (; i < count; i++) {
+			result[i] = (uint8_t)ScalarOps::Mask(kernel(ScalarOps(), i));
+		}
+	}
+
+	template<class Ops>
+	static typename Ops::Reg SphereSphereKernel(const SphereBatch& a, const SphereBatch& b, size_t i) {
+		typedef typename Ops::Reg Reg;
+		Reg dist2 = Ops::Set(0.0f);
+		for (int c = 0; c < 3; c++) {
+			Reg d = Ops::Sub(Ops::Load(&b.center[c][i]), Ops::Load(&a.center[c][i]));
+			dist2 = Ops::Add(dist2, Ops::Mul(d, d));
+		}
+		Reg sum = Ops::Add(Ops::Load(&a.radius[i]), Ops::Load(&b.radius[i]));
+		return Ops::Le(dist2, Ops::Mul(sum, sum));
+	}
+
+	template<class Ops>
+	static typename Ops::Reg SphereAABBKernel(const SphereBatch& a, const AABBBatch& b, size_t i) {
+		typedef typename Ops::Reg Reg;
+		Reg dist2 = Ops::Set(0.0f);
+		for (int c = 0; c < 3; c++) {
+			Reg center = Ops::Load(&a.center[c][i]);
+			Reg closest = Ops::Min(Ops::Max(center, Ops::Load(&b.min[c][i])), Ops::Load(&b.max[c][i]));
+			Reg d = Ops::Sub(center, closest);
+			dist2 = Ops::Add(dist2, Ops::Mul(d, d));
+		}
+		Reg r = Ops::Load(&a.radius[i]);
+		return Ops::Le(dist2, Ops::Mul(r, r));
+	}
+
+	template<class Ops>
+	static typename Ops::Reg AABBAABBKernel(const AABBBatch& a, const AABBBatch& b, size_t i) {
+		typedef typename Ops::Reg Reg;
+		Reg res = Ops::Le(Ops::Load(&a.min[0][i]), Ops::Load(&b.max[0][i]));
+		res = Ops::And(res, Ops::Le(Ops::Load(&b.min[0][i]), Ops::Load(&a.max[0][i])));
+		for (int c = 1; c < 3; c++) {
+			res = Ops::And(res, Ops::Le(Ops::Load(&a.min[c][i]), Ops::Load(&b.max[c][i])));
+			res = Ops::And(res, Ops::Le(Ops::Load(&b.min[c][i]), Ops::Load(&a.max[c][i])));
+		}
+		return res;
+	}
+
+	template<class Ops>
+	static typename Ops::Reg OBBOBBKernel(const OBBBatch& a, const OBBBatch& b, size_t i) {
+		typedef typename Ops::Reg Reg;
+		//Epsilon added to the absolute rotation, avoid false separation when two edges are parallel.
+		const Reg epsilon = Ops::Set(1e-6f);
+
+		Reg aAxis[9], bAxis[9], ha[3], hb[3], d[3];
+		for (int k = 0; k < 9; k++) {
+			aAxis[k] = Ops::Load(&a.axis[k][i]);
+			bAxis[k] = Ops::Load(&b.axis[k][i]);
+		}
+		for (int k = 0; k < 3; k++) {
+			ha[k] = Ops::Load(&a.halfSize[k][i]);
+			hb[k] = Ops::Load(&b.halfSize[k][i]);
+			d[k] = Ops::Sub(Ops::Load(&b.center[k][i]), Ops::Load(&a.center[k][i]));
+		}
+
+		//Rotation of b in the frame of a, and translation in the frame of a.
+		Reg r[3][3], absR[3][3], t[3];
+		for (int x = 0; x < 3; x++) {
+			for (int y = 0; y < 3; y++) {
+				r[x][y] = Ops::Add(Ops::Add(Ops::Mul(aAxis[x * 3], bAxis[y * 3]), Ops::Mul(aAxis[x * 3 + 1], bAxis[y * 3 + 1])), Ops::Mul(aAxis[x * 3 + 2], bAxis[y * 3 + 2]));
+				absR[x][y] = Ops::Add(Ops::Abs(r[x][y]), epsilon);
+			}
+			t[x] = Ops::Add(Ops::Add(Ops::Mul(d[0], aAxis[x * 3]), Ops::Mul(d[1], aAxis[x * 3 + 1])), Ops::Mul(d[2], aAxis[x * 3 + 2]));
+		}
+
+		Reg separated = Ops::Set(0.0f);
+
+		//Axis of a.
+		for (int x = 0; x < 3; x++) {
+			Reg rb = Ops::Add(Ops::Add(Ops::Mul(hb[0], absR[x][0]), Ops::Mul(hb[1], absR[x][1])), Ops::Mul(hb[2], absR[x][2]));
+			separated = Ops::Or(separated, Ops::Gt(Ops::Abs(t[x]), Ops::Add(ha[x], rb)));
+		}
+
+		//Axis of b.
+		for (int y = 0; y < 3; y++) {
+			Reg ra = Ops::Add(Ops::Add(Ops::Mul(ha[0], absR[0][y]), Ops::Mul(ha[1], absR[1][y])), Ops::Mul(ha[2], absR[2][y]));
+			Reg proj = Ops::Add(Ops::Add(Ops::Mul(t[0], r[0][y]), Ops::Mul(t[1], r[1][y])), Ops::Mul(t[2], r[2][y]));
+			separated = Ops::Or(separated, Ops::Gt(Ops::Abs(proj), Ops::Add(ra, hb[y])));
+		}
+
+		//Cross product of the axis of a and b.
+		for (int x = 0; x < 3; x++) {
+			int x1 = (x + 1) % 3, x2 = (x + 2) % 3;
+			for (int y = 0; y < 3; y++) {
+				int y1 = (y + 1) % 3, y2 = (y + 2) % 3;
+				Reg ra = Ops::Add(Ops::Mul(ha[x1], absR[x2][y]), Ops::Mul(ha[x2], absR[x1][y]));
+				Reg rb = Ops::Add(Ops::Mul(hb[y1], absR[x][y2]), Ops::Mul(hb[y2], absR[x][y1]));
+				Reg proj = Ops::Sub(Ops::Mul(t[x2], r[x1][y]), Ops::Mul(t[x1], r[x2][y]));
+				separated = Ops::Or(separated, Ops::Gt(Ops::Abs(proj), Ops::Add(ra, rb)));
+			}
+		}
+
+		return Ops::Not(separated);
+	}
+};
+
+#endif // !__BATCH_DETECTION_HPP__
@@ -10,10 +10,30 @@
 /// A Bounding Box collider. (AABB and OBB)
 /// </summary>
 class BoundingBoxCollider : public ICollider {
+public:
+	/// <summary>
+	/// World space data of the box, computed once per frame.
+	/// </summary>
+	struct WorldCache {
+		/// <param name="center">The center of the box.</param>
+		/// <param name="axis">The 3 normalized axis of the box.</param>
+		/// <param name="halfSize">The half size on each axis, with the scale.</param>
+		/// <param name="min">The min of the AABB enclosing the box.</param>
+		/// <param name="max">The max of the AABB enclosing the box.</param>
+		/// <param name="corners">The 8 corners of the box, corner i use -/+ axis[k] if the bit k of i is 0/1.</param>
+		glm::vec3 center = glm::vec3(0);
+		glm::vec3 axis[3] = { glm::vec3(1,0,0), glm::vec3(0,1,0), glm::vec3(0,0,1) };
+		glm::vec3 halfSize = glm::vec3(0);
+		glm::vec3 min = glm::vec3(0);
+		glm::vec3 max = glm::vec3(0);
+		glm::vec3 corners[8];
+	};
+
 protected:
 	glm::vec3 center;
 	glm::vec3 halfSize;
 
+	WorldCache world;
 	
 public:
 	/// <summary>
@@ -30,7 +50,7 @@ public:
 	/// Create a bounding box, with a list of points.
 	/// </summary>
 	/// <param name="points">Points in 3D space</param>
-	BoundingBoxCollider(std::vector<glm::vec3> points) {
+	BoundingBoxCollider(std::vector<glm::vec3> points) : ICollider(Type::BoundingBox) {
 		Update(points);
 	}
 
@@ -53,6 +73,83 @@ public:
 		}
 		this->center = (max + min) / 2.0f;
 		this->halfSize = (max - min) / 2.0f;
+		InvalidateWorldCache();
+	}
+
+	/// <summary>
+	/// Compute the world space data of the box, with the global matrix of the gameobject. Kept as is while the gameobject does not move.
+	/// </summary>
+	void UpdateWorldCache() override {
+		if (!IsTransformChanged()) {
+			ICollider::UpdateWorldCache();
+			return;
+		}
+
+		glm::mat4 m = this->attachment->GetMatrixRecursive();
+		glm::vec3 oldCenter = this->world.center, oldHalfSize = this->world.halfSize;
+		glm::vec3 oldAxis[3] = { this->world.axis[0], this->world.axis[1], this->world.axis[2] };
+
+		this->world.center = glm::vec3(m * glm::vec4(this->center, 1.0f));
+
+		glm::vec3 extent = glm::vec3(0);
+		for (int i = 0; i < 3; i++) {
+			glm::vec3 col = glm::vec3(m[i]);
+			float len = glm::length(col);
+			this->world.axis[i] = len > 0.0f ? col / len : glm::vec3(i == 0, i == 1, i == 2);
+			this->world.halfSize[i] = this->halfSize[i] * len;
+			extent += glm::abs(col) * this->halfSize[i];
+		}
+		this->world.min = this->world.center - extent;
+		this->world.max = this->world.center + extent;
+
+		if (this->worldVersion == 0 || oldCenter != this->world.center || oldHalfSize != this->world.halfSize ||
+			oldAxis[0] != this->world.axis[0] || oldAxis[1] != this->world.axis[1] || oldAxis[2] != this->world.axis[2]) {
+			this->worldVersion++;
+		}
+
+		for (int i = 0; i < 8; i++) {
+			glm::vec3 c = this->world.center;
+			for (int k = 0; k < 3; k++) {
+				c += this->world.axis[k] * (((i >> k) & 1) ? this->world.halfSize[k] : -this->world.halfSize[k]);
+			}
+			this->world.corners[i] = c;
+		}
+
+		ICollider::UpdateWorldCache();
+	}
+
+	/// <summary>
+	/// Return the world space data of the box, computed if outdated.
+	/// </summary>
+	/// <returns>The world cache</returns>
+	const WorldCache& GetWorld() {
+		if (!IsWorldCacheValid()) {
+			UpdateWorldCache();
+		}
+		return this->world;
+	}
+
+	/// <summary>
+	/// Return the world space AABB enclosing the box.
+	/// </summary>
+	/// <param name="min">the Min result</param>
+	/// <param name="max">the Max result</param>
+	void GetWorldBounds(glm::vec3& min, glm::vec3& max) override {
+		GetMinMax(min, max);
+	}
+
+	/// <summary>
+	/// Return the corner of the box the farthest in a direction.
+	/// </summary>
+	/// <param name="direction">The direction</param>
+	/// <returns>The support point, in world space</returns>
+	glm::vec3 Support(glm::vec3 direction) override {
+		const WorldCache& w = GetWorld();
+		glm::vec3 p = w.center;
+		for (int k = 0; k < 3; k++) {
+			p += w.axis[k] * (glm::dot(direction, w.axis[k]) >= 0.0f ? w.halfSize[k] : -w.halfSize[k]);
+		}
+		return p;
 	}
 
 	/// <summary>
@@ -60,7 +157,7 @@ public:
 	/// </summary>
 	/// <returns>The min AABB value</returns>
 	glm::vec3 GetMin() {
-		return (this->center - halfSize) + this->attachment->GetPositionWithRecursiveMatrix();
+		return GetWorld().min;
 	}
 
 	/// <summary>
@@ -68,7 +165,7 @@ public:
 	/// </summary>
 	/// <returns>The Max AABB value</returns>
 	glm::vec3 GetMax() {
-		return (this->center + halfSize) + this->attachment->GetPositionWithRecursiveMatrix();
+		return GetWorld().max;
 	}
 
 	/// <summary>
@@ -77,9 +174,9 @@ public:
 	/// <param name="min">the Min result</param>
 	/// <param name="max">the Max result</param>
 	void GetMinMax(glm::vec3& min, glm::vec3& max) {
-		glm::vec3 pos = this->attachment->GetPositionWithRecursiveMatrix();
-		min = (this->center - halfSize) + pos;
-		max = (this->center + halfSize) + pos;
+		const WorldCache& w = GetWorld();
+		min = w.min;
+		max = w.max;
 	}
 
 	/// <summary>
@@ -116,7 +213,7 @@ public:
 	/// </summary>
 	/// <returns>the Center value for AABB</returns>
 	glm::vec3 GetCenter() {
-		return this->center + this->attachment->GetPositionWithRecursiveMatrix();
+		return GetWorld().center;
 	}
 
 	/// <summary>
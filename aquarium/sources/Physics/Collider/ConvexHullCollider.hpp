@@ -0,0 +1,147 @@
+#ifndef __CONVEX_HULL_COLLIDER_HPP__
+#define __CONVEX_HULL_COLLIDER_HPP__
+
+#include <vector>
+#include <cfloat>
+#include <glm/glm.hpp>
+#include <Physics/Collider/ICollider.hpp>
+
+/// <summary>
+/// A Convex hull collider, the convex hull of a point cloud (e.g. the points of a model).
+/// The hull is never built, the GJK only needs the support point, the farthest point of the cloud in a direction.
+/// </summary>
+class ConvexHullCollider : public ICollider {
+public:
+	/// <summary>
+	/// World space data of the hull, computed when the gameobject move.
+	/// </summary>
+	struct WorldCache {
+		/// <param name="points">The points, in world space.</param>
+		/// <param name="center">The average of the points.</param>
+		/// <param name="min">The min of the AABB enclosing the hull.</param>
+		/// <param name="max">The max of the AABB enclosing the hull.</param>
+		std::vector<glm::vec3> points;
+		glm::vec3 center = glm::vec3(0);
+		glm::vec3 min = glm::vec3(0);
+		glm::vec3 max = glm::vec3(0);
+	};
+
+protected:
+	std::vector<glm::vec3> points;
+
+	WorldCache world;
+
+public:
+	/// <summary>
+	/// Create a Convex hull collider.
+	/// </summary>
+	/// <param name="points">The points of the hull, in the local space of the gameobject. The points inside the hull are allowed but slow down the support.</param>
+	ConvexHullCollider(std::vector<glm::vec3> points) : ICollider(Type::ConvexHull) {
+		this->points = points;
+	}
+
+	/// <summary>
+	/// Change the points of the hull.
+	/// </summary>
+	/// <param name="points">The points of the hull, in the local space of the gameobject.</param>
+	void SetPoints(std::vector<glm::vec3> points) {
+		this->points = points;
+		InvalidateWorldCache();
+	}
+
+	/// <summary>
+	/// Return the points of the hull, in local space.
+	/// </summary>
+	/// <returns>The points</returns>
+	std::vector<glm::vec3> GetPoints() {
+		return this->points;
+	}
+
+	/// <summary>
+	/// Return the center of the hull, the average of its points.
+	/// </summary>
+	/// <returns>The center in world space</returns>
+	glm::vec3 GetCenter() {
+		return GetWorld().center;
+	}
+
+	/// <summary>
+	/// Compute the world space points of the hull, with the global matrix of the gameobject. Kept as is while the gameobject does not move.
+	/// </summary>
+	void UpdateWorldCache() override {
+		if (!IsTransformChanged()) {
+			ICollider::UpdateWorldCache();
+			return;
+		}
+
+		glm::mat4 m = this->attachment->GetMatrixRecursive();
+		this->world.points.resize(this->points.size());
+		this->world.center = glm::vec3(0);
+		this->world.min = glm::vec3(FLT_MAX);
+		this->world.max = glm::vec3(-FLT_MAX);
+		for (size_t i = 0, max = this->points.size(); i < max; i++) {
+			glm::vec3 p = glm::vec3(m * glm::vec4(this->points[i], 1.0f));
+			this->world.points[i] = p;
+			this->world.center += p;
+			this->world.min = glm::min(this->world.min, p);
+			this->world.max = glm::max(this->world.max, p);
+		}
+		if (this->points.empty()) {
+			this->world.center = this->world.min = this->world.max = glm::vec3(m[3]);
+		}
+		else {
+			this->world.center /= (float)this->points.size();
+		}
+
+		//The transformation changed, the hull moved.
+		this->worldVersion++;
+
+		ICollider::UpdateWorldCache();
+	}
+
+	/// <summary>
+	/// Return the world space AABB enclosing the hull.
+	/// </summary>
+	/// <param name="min">the Min result</param>
+	/// <param name="max">the Max result</param>
+	void GetWorldBounds(glm::vec3& min, glm::vec3& max) override {
+		const WorldCache& w = GetWorld();
+		min = w.min;
+		max = w.max;
+	}
+
+	/// <summary>
+	/// Return the point of the hull the farthest in a direction.
+	/// </summary>
+	/// <param name="direction">The direction</param>
+	/// <returns>The support point, in world space</returns>
+	glm::vec3 Support(glm::vec3 direction) override {
+		const WorldCache& w = GetWorld();
+		if (w.points.empty()) {
+			return w.center;
+		}
+		size_t best = 0;
+		float bestDot = glm::dot(w.points[0], direction);
+		for (size_t i = 1, max = w.points.size(); i < max; i++) {
+			float d = glm::dot(w.points[i], direction);
+			if (d > bestDot) {
+				bestDot = d;
+				best = i;
+			}
+		}
+		return w.points[best];
+	}
+
+	/// <summary>
+	/// Return the world space data of the hull, computed if outdated.
+	/// </summary>
+	/// <returns>The world cache</returns>
+	const WorldCache& GetWorld() {
+		if (!IsWorldCacheValid()) {
+			UpdateWorldCache();
+		}
+		return this->world;
+	}
+};
+
+#endif // !__CONVEX_HULL_COLLIDER_HPP__
@@ -3,24 +3,38 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 #include <glm/glm.hpp>
 
 #include <Engine/Component/Component.hpp>
 
 /// <summary>
-/// Collider abstract class for BoundingBoxCollider and SphereCollider.
+/// Collider abstract class for BoundingBoxCollider, SphereCollider and ConvexHullCollider.
 /// </summary>
 class ICollider : public Component {
 public:
 	enum Type {
 		None,
 		BoundingBox,
-		Sphere
+		Sphere,
+		ConvexHull
 	};
 protected :
 	Type type;
 	bool trigger;
 	bool isCollision = false;
+
+	//Frame of the last world cache update, the cache is valid while it equal worldFrame.
+	uint64_t cacheFrame = 0;
+
+	//Incremented each time the world cache change, to know if a collider moved since a previous test.
+	uint64_t worldVersion = 0;
+
+	//Recursive transformation version of the gameobject at the last world cache update, the cache is not recomputed while it does not change.
+	uint64_t transformVersion = 0;
+
+	//Current frame of the world caches, incremented by the physics each frame.
+	inline static uint64_t worldFrame = 1;
 public:
 	/// <summary>
 	/// Create an ICollider object
@@ -29,6 +43,7 @@ public:
 	/// <param name="trigger">Is the collider a trigger ?</param>
 	ICollider(Type type = Type::None, bool trigger = false) {
 		this->type = type;
+		this->trigger = trigger;
 	}
 
 	/// <summary>
@@ -62,6 +77,102 @@ public:
 	Type ColliderType(){
 		return this->type;
 	}
+
+	/// <summary>
+	/// Return if the collider is a trigger (collision events only, no contact response).
+	/// </summary>
+	/// <returns>Is trigger ?</returns>
+	bool IsTrigger() {
+		return this->trigger;
+	}
+
+	/// <summary>
+	/// Set if the collider is a trigger.
+	/// </summary>
+	/// <param name="trigger">Is trigger ?</param>
+	void SetTrigger(bool trigger) {
+		this->trigger = trigger;
+	}
+
+	/// <summary>
+	/// Start a new frame for the world caches, every cache become outdated.
+	/// </summary>
+	static void NextWorldFrame() {
+		worldFrame++;
+	}
+
+	/// <summary>
+	/// Compute the world space data of the collider for the current frame, overrided by each collider.
+	/// </summary>
+	virtual void UpdateWorldCache() {
+		this->cacheFrame = worldFrame;
+	}
+
+	/// <summary>
+	/// Force the world cache to be recomputed on the next access (e.g. after moving the object during the frame).
+	/// </summary>
+	void InvalidateWorldCache() {
+		this->cacheFrame = 0;
+		this->transformVersion = 0;
+	}
+
+	/// <summary>
+	/// Return if the gameobject or one of its parents moved since the last call, a still collider keep its world cache.
+	/// </summary>
+	/// <returns>Has moved ?</returns>
+	bool IsTransformChanged() {
+		uint64_t version = this->attachment->GetTransformVersionRecursive();
+		if (version == this->transformVersion) {
+			return false;
+		}
+		this->transformVersion = version;
+		return true;
+	}
+
+	/// <summary>
+	/// Return if the world cache was computed for the current frame.
+	/// </summary>
+	/// <returns>Is the cache valid ?</returns>
+	bool IsWorldCacheValid() {
+		return this->cacheFrame == worldFrame;
+	}
+
+	/// <summary>
+	/// Return the version of the world cache, changed only when the collider moved, rotated or was resized.
+	/// </summary>
+	/// <returns>The world version</returns>
+	uint64_t GetWorldVersion() {
+		return this->worldVersion;
+	}
+
+	/// <summary>
+	/// Return the world space AABB enclosing the collider, used by the broadphase. Without override, an empty box at the origin.
+	/// </summary>
+	/// <param name="min">the Min result</param>
+	/// <param name="max">the Max result</param>
+	virtual void GetWorldBounds(glm::vec3& min, glm::vec3& max) {
+		min = glm::vec3(0);
+		max = glm::vec3(0);
+	}
+
+	/// <summary>
+	/// Return the farthest point of the collider in a direction, in world space, used by the GJK. Without override, the center of the world bounds.
+	/// </summary>
+	/// <param name="direction">The direction, not necessarily normalized</param>
+	/// <returns>The support point</returns>
+	virtual glm::vec3 Support(glm::vec3 /*direction*/) {
+		glm::vec3 min, max;
+		GetWorldBounds(min, max);
+		return (min + max) * 0.5f;
+	}
+
+	/// <summary>
+	/// Set the collision state of the collider, updated by the physics each frame.
+	/// </summary>
+	/// <param name="collision">Is colliding ?</param>
+	void SetCollision(bool collision) {
+		this->isCollision = collision;
+	}
 };
 
 #endif
\ No newline at end of file
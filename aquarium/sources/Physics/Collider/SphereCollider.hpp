@@ -3,15 +3,33 @@
 
 #include <glm/glm.hpp>
 #include <vector>
+#include <cmath>
 #include <Physics/Collider/ICollider.hpp>
 
 /// <summary>
 /// A Sphere collider.
 /// </summary>
 class SphereCollider : public ICollider {
+public:
+	/// <summary>
+	/// World space data of the sphere, computed once per frame.
+	/// </summary>
+	struct WorldCache {
+		/// <param name="center">The center of the sphere.</param>
+		/// <param name="radius">The radius, with the biggest scale of the object.</param>
+		/// <param name="min">The min of the AABB enclosing the sphere.</param>
+		/// <param name="max">The max of the AABB enclosing the sphere.</param>
+		glm::vec3 center = glm::vec3(0);
+		float radius = 0.0f;
+		glm::vec3 min = glm::vec3(0);
+		glm::vec3 max = glm::vec3(0);
+	};
+
 protected:
 	glm::vec3 center;
 	double radius;
+
+	WorldCache world;
 public :
 	/// <summary>
 	/// Create a Sphere collider
@@ -44,7 +62,69 @@ public :
 	/// </summary>
 	/// <returns>The center of the sphere</returns>
 	glm::vec3 GetCenter() {
-		return this->center + this->attachment->GetTransform()->getPosition();
+		return GetWorld().center;
+	}
+
+	/// <summary>
+	/// Compute the world space data of the sphere, with the global matrix of the gameobject. Kept as is while the gameobject does not move.
+	/// </summary>
+	void UpdateWorldCache() override {
+		if (!IsTransformChanged()) {
+			ICollider::UpdateWorldCache();
+			return;
+		}
+
+		glm::mat4 m = this->attachment->GetMatrixRecursive();
+		float scale = fmaxf(glm::length(glm::vec3(m[0])), fmaxf(glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2]))));
+		glm::vec3 oldCenter = this->world.center;
+		float oldRadius = this->world.radius;
+
+		this->world.center = glm::vec3(m * glm::vec4(this->center, 1.0f));
+		this->world.radius = (float)this->radius * scale;
+		this->world.min = this->world.center - glm::vec3(this->world.radius);
+		this->world.max = this->world.center + glm::vec3(this->world.radius);
+
+		if (this->worldVersion == 0 || oldCenter != this->world.center || oldRadius != this->world.radius) {
+			this->worldVersion++;
+		}
+
+		ICollider::UpdateWorldCache();
+	}
+
+	/// <summary>
+	/// Return the world space AABB enclosing the sphere.
+	/// </summary>
+	/// <param name="min">the Min result</param>
+	/// <param name="max">the Max result</param>
+	void GetWorldBounds(glm::vec3& min, glm::vec3& max) override {
+		const WorldCache& w = GetWorld();
+		min = w.min;
+		max = w.max;
+	}
+
+	/// <summary>
+	/// Return the point of the sphere the farthest in a direction.
+	/// </summary>
+	/// <param name="direction">The direction</param>
+	/// <returns>The support point, in world space</returns>
+	glm::vec3 Support(glm::vec3 direction) override {
+		const WorldCache& w = GetWorld();
+		float length = glm::length(direction);
+		if (length <= 0.0f) {
+			return w.center + glm::vec3(w.radius, 0, 0);
+		}
+		return w.center + direction * (w.radius / length);
+	}
+
+	/// <summary>
+	/// Return the world space data of the sphere, computed if outdated.
+	/// </summary>
+	/// <returns>The world cache</returns>
+	const WorldCache& GetWorld() {
+		if (!IsWorldCacheValid()) {
+			UpdateWorldCache();
+		}
+		return this->world;
 	}
 
 	/// <summary>
@@ -0,0 +1,50 @@
+#ifndef __COLLISION_BEHAVIOR_HPP__
+#define __COLLISION_BEHAVIOR_HPP__
+
+#include <glm/glm.hpp>
+#include <Physics/Collider/ICollider.hpp>
+
+/// <summary>
+/// Collision Behavior object. Used by the physics to notify a component that one of the colliders of its gameobject start, continue or stop colliding.
+/// </summary>
+class CollisionBehavior
+{
+public:
+
+	/// <summary>
+	/// Informations of a collision, from the point of view of the notified gameobject.
+	/// </summary>
+	struct Collision {
+		/// <param name="collider">The collider of the notified gameobject.</param>
+		/// <param name="other">The other collider.</param>
+		/// <param name="closestPoint">The closest point of the collision, in world space.</param>
+		ICollider* collider;
+		ICollider* other;
+		glm::vec3 closestPoint;
+	};
+
+	/// <summary>
+	/// Collision Behavior object. Used by the physics to notify collisions.
+	/// </summary>
+	CollisionBehavior() {}
+
+	/// <summary>
+	/// Called the first frame the two colliders collide.
+	/// </summary>
+	/// <param name="collision">The collision informations</param>
+	virtual void OnCollisionEnter(Collision /*collision*/) {}
+
+	/// <summary>
+	/// Called each following frame while the two colliders collide.
+	/// </summary>
+	/// <param name="collision">The collision informations</param>
+	virtual void OnCollisionStay(Collision /*collision*/) {}
+
+	/// <summary>
+	/// Called the first frame the two colliders stop colliding.
+	/// </summary>
+	/// <param name="collision">The collision informations</param>
+	virtual void OnCollisionExit(Collision /*collision*/) {}
+};
+
+#endif // !__COLLISION_BEHAVIOR_HPP__
@@ -1,9 +1,12 @@
 #ifndef __COLLISION_DETECTION_HPP__
 #define __COLLISION_DETECTION_HPP__
 
+#include <limits>
 #include <glm/glm.hpp>
 #include <Physics/Collider/BoundingBoxCollider.hpp>
 #include <Physics/Collider/SphereCollider.hpp>
+#include <Physics/Collider/ConvexHullCollider.hpp>
+#include <Physics/GJK.hpp>
 #include <Engine/GameObject.hpp>
 
 
@@ -33,13 +36,19 @@ public:
 		/// </summary>
 		/// <param name="collision">If there are a collision or not.</param>
 		/// <param name="closestPoint">The closest point hit of the object.</param>
+		/// <param name="normal">The contact normal, from the first object to the second one (when computed).</param>
+		/// <param name="depth">The penetration depth along the normal (when computed).</param>
 
 		bool collision = false;
 		glm::vec3 closestPoint;
+		glm::vec3 normal = glm::vec3(0);
+		float depth = 0.0f;
 
-		Data(bool c, glm::vec3 cp) {
+		Data(bool c, glm::vec3 cp, glm::vec3 n = glm::vec3(0), float d = 0.0f) {
 			this->collision = c;
 			this->closestPoint = cp;
+			this->normal = n;
+			this->depth = d;
 		}
 	};
 
@@ -55,8 +64,8 @@ public:
 
 		Triangle(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2) {
 			this->points[0] = p0;
-			this->points[0] = p1;
-			this->points[0] = p2;
+			this->points[1] = p1;
+			this->points[2] = p2;
 		}
 		/// <summary>
 		/// Override the [] operator to access directly points[].
@@ -72,7 +81,7 @@ public:
 
 		Plane() { normal = glm::vec3(1, 0, 0); }
 		Plane(glm::vec3 norm, float d) {
-			this->normal = normal;
+			this->normal = norm;
 			this->distance = d;
 		}
 	};
@@ -80,27 +89,30 @@ public:
 	static glm::vec3 Project(glm::vec3 length, glm::vec3 dir) {
 		return dir * (glm::dot(length, dir) / glm::dot(dir, dir));
 	}
+	/// <summary>
+	/// Compute the barycentric coordinates of a point on the plane of a triangle.
+	/// </summary>
+	/// <param name="p">The point</param>
+	/// <param name="t">The triangle</param>
+	/// <returns>The weights of the 3 points of the triangle</returns>
 	static glm::vec3 Barycentric(glm::vec3 p, Triangle t) {
-		glm::vec3 ap = p - t[0];
-		glm::vec3 bp = p - t[1];
-		glm::vec3 cp = p - t[1];
-
 		glm::vec3 ab = t[1] - t[0];
-		glm::vec3 ac = t[1] - t[0];
-		glm::vec3 bc = t[1] - t[1];
-		glm::vec3 cb = t[1] - t[1];
-		glm::vec3 ca = t[0] - t[1];
-
-		glm::vec3 v = ab - CollisionDetection::Project(ab, cb);
-		float a = 1.0f - (glm::dot(v, ap) / glm::dot(v, ab));
-
-		v = bc - CollisionDetection::Project(bc, ac);
-		float b = 1.0f - (glm::dot(v, bp) / glm::dot(v, bc));
+		glm::vec3 ac = t[2] - t[0];
+		glm::vec3 ap = p - t[0];
 
-		v = ca - CollisionDetection::Project(ca, ab);
-		float c = 1.0f - (glm::dot(v, cp) / glm::dot(v, ca));
+		float d00 = glm::dot(ab, ab);
+		float d01 = glm::dot(ab, ac);
+		float d11 = glm::dot(ac, ac);
+		float d20 = glm::dot(ap, ab);
+		float d21 = glm::dot(ap, ac);
+		float denom = d00 * d11 - d01 * d01;
+		if (denom == 0.0f) {
+			return glm::vec3(-1.0f);
+		}
 
-		return glm::vec3(a, b, c);
+		float b = (d11 * d20 - d01 * d21) / denom;
+		float c = (d00 * d21 - d01 * d20) / denom;
+		return glm::vec3(1.0f - b - c, b, c);
 	}
 
 	static bool EpsilonCompare(double x, double y) {
@@ -145,6 +157,10 @@ public:
 				return Detection(s, collider2);
 			}
 		}
+		else if (collider1->ColliderType() == ICollider::ConvexHull) {
+			return Convex_Convex(collider1, collider2);
+		}
+		return Data(false, glm::vec3(0));
 	}
 
 	/// <summary>
@@ -168,6 +184,10 @@ public:
 
 			}
 		}
+		else if (two->ColliderType() == ICollider::ConvexHull) {
+			return Convex_Convex(one, two);
+		}
+		return Data(false, glm::vec3(0));
 	}
 
 	/// <summary>
@@ -190,6 +210,10 @@ public:
 				return Detection(one, s);
 			}
 		}
+		else if (two->ColliderType() == ICollider::ConvexHull) {
+			return Convex_Convex(one, two);
+		}
+		return Data(false, glm::vec3(0));
 	}
 
 
@@ -275,8 +299,9 @@ public:
 	static Data AABB_AABB(BoundingBoxCollider* one, BoundingBoxCollider* two) {
 		glm::vec3 closestPoint;
 		glm::vec3 c = one->GetCenter();
-		glm::vec3 aMin = one->GetMin(), aMax = one->GetMax();
-		glm::vec3 bMin = one->GetMin(), bMax = one->GetMax();
+		glm::vec3 aMin, aMax, bMin, bMax;
+		one->GetMinMax(aMin, aMax);
+		two->GetMinMax(bMin, bMax);
 
 		bool collision = (aMin.x <= bMax.x && aMax.x >= bMin.x) &&
 			(aMin.y <= bMax.y && aMax.y >= bMin.y) &&
@@ -291,7 +316,21 @@ public:
 			closestPoint = tmp.closestPoint;
 		}
 
-		return Data(collision, closestPoint);
+		if (!collision) {
+			return Data(false, closestPoint);
+		}
+
+		//Axis of minimum penetration, for the contact normal.
+		glm::vec3 overlap = glm::min(aMax, bMax) - glm::max(aMin, bMin);
+		int axis = 0;
+		for (int i = 1; i < 3; ++i) {
+			if (overlap[i] < overlap[axis]) {
+				axis = i;
+			}
+		}
+		glm::vec3 normal = glm::vec3(0);
+		normal[axis] = (bMin[axis] + bMax[axis]) >= (aMin[axis] + aMax[axis]) ? 1.0f : -1.0f;
+		return Data(true, closestPoint, normal, overlap[axis]);
 	}
 
 	/// <summary>
@@ -304,30 +343,60 @@ public:
 		bool collision = true;
 		glm::vec3 closestPoint = glm::vec3(0);
 
-		glm::mat3 o1(one->attachment->GetTransform()->getRotationMatrix());
-		glm::mat3 o2(two->attachment->GetTransform()->getRotationMatrix());
+		const BoundingBoxCollider::WorldCache& w1 = one->GetWorld();
+		const BoundingBoxCollider::WorldCache& w2 = two->GetWorld();
 
 		glm::vec3 test[15] = {
-			glm::vec3(o1[0][0], o1[0][1], o1[0][2]),
-			glm::vec3(o1[1][0], o1[1][1], o1[1][2]),
-			glm::vec3(o1[2][0], o1[2][1], o1[2][2]),
-			glm::vec3(o2[0][0], o2[0][1], o2[0][2]),
-			glm::vec3(o2[1][0], o2[1][1], o2[1][2]),
-			glm::vec3(o2[2][0], o2[2][1], o2[2][2])
+			w1.axis[0],
+			w1.axis[1],
+			w1.axis[2],
+			w2.axis[0],
+			w2.axis[1],
+			w2.axis[2]
 		};
 
 		for (int i = 0; i < 3; ++i) { // Fill out rest of axis
-			test[6 + i * 3 + 0] = glm::cross(test[i], test[0]);
-			test[6 + i * 3 + 1] = glm::cross(test[i], test[1]);
-			test[6 + i * 3 + 2] = glm::cross(test[i], test[2]);
+			test[6 + i * 3 + 0] = glm::cross(test[i], test[3]);
+			test[6 + i * 3 + 1] = glm::cross(test[i], test[4]);
+			test[6 + i * 3 + 2] = glm::cross(test[i], test[5]);
 		}
 
+		//Axis of minimum penetration, for the contact normal.
+		glm::vec3 normal = glm::vec3(0);
+		float depth = FLT_MAX;
+
 		for (int i = 0; i < 15 && collision; ++i) {
-			if (!AxisOverlap(one, two, test[i], M_OBB_OBB)) {
+			float len = glm::length(test[i]);
+			if (len < 1e-6f) { // Parallel edges, the axis is already tested by a face axis.
+				continue;
+			}
+			glm::vec3 axis = test[i] / len;
+			float overlap = AxisPenetration(one, two, axis, M_OBB_OBB);
+			if (overlap < 0.0f) {
 				collision = false;
 			}
+			else if (overlap < depth) {
+				depth = overlap;
+				normal = axis;
+			}
 		}
-		return Data(collision, closestPoint);
+
+		if (!collision) {
+			return Data(false, closestPoint);
+		}
+
+		if (glm::dot(normal, w2.center - w1.center) < 0.0f) {
+			normal = -normal;
+		}
+
+		//Deepest corner of two inside one.
+		closestPoint = w2.corners[0];
+		for (int i = 1; i < 8; ++i) {
+			if (glm::dot(w2.corners[i], normal) < glm::dot(closestPoint, normal)) {
+				closestPoint = w2.corners[i];
+			}
+		}
+		return Data(true, closestPoint, normal, depth);
 	}
 
 	/// <summary>
@@ -350,21 +419,21 @@ public:
 		bool collision = true;
 		glm::vec3 closestPoint = glm::vec3(0);
 
-		glm::mat3 o(one->attachment->GetTransform()->getRotationMatrix());
+		const BoundingBoxCollider::WorldCache& w = one->GetWorld();
 
 		glm::vec3 test[15] = {
 			glm::vec3(1,0,0),
 			glm::vec3(0,1,0),
 			glm::vec3(0,0,1),
-			glm::vec3(o[0][0], o[0][1], o[0][2]),
-			glm::vec3(o[1][0], o[1][1], o[1][2]),
-			glm::vec3(o[2][0], o[2][1], o[2][2])
+			w.axis[0],
+			w.axis[1],
+			w.axis[2]
 		};
 
 		for (int i = 0; i < 3; ++i) { // Fill out rest of axis
-			test[6 + i * 3 + 0] = glm::cross(test[i], test[0]);
-			test[6 + i * 3 + 1] = glm::cross(test[i], test[1]);
-			test[6 + i * 3 + 2] = glm::cross(test[i], test[2]);
+			test[6 + i * 3 + 0] = glm::cross(test[i], test[3]);
+			test[6 + i * 3 + 1] = glm::cross(test[i], test[4]);
+			test[6 + i * 3 + 2] = glm::cross(test[i], test[5]);
 		}
 
 		for (int i = 0; i < 15 && collision; ++i) {
@@ -386,10 +455,10 @@ public:
 	}
 
 	static Data Sphere_AABB(SphereCollider* one, BoundingBoxCollider* two) {
-		glm::vec3 oneCenter = one->GetCenter();
-		Data d = Point_AABB(oneCenter, two);
+		const SphereCollider::WorldCache& w = one->GetWorld();
+		Data d = Point_AABB(w.center, two);
 		if (!d.collision) {
-			d.collision = glm::distance(oneCenter, d.closestPoint) < one->GetRadius() * one->GetRadius();
+			d.collision = glm::distance(w.center, d.closestPoint) <= w.radius;
 		}
 		return d;
 	}
@@ -411,10 +480,30 @@ public:
 	/// <param name="two">A OBB BoundingBoxCollider.</param>
 	/// <returns>The Data of the collision.</returns>
 	static Data Sphere_OBB(SphereCollider* one, BoundingBoxCollider* two) {
-		glm::vec3 oneCenter = one->GetCenter();
-		Data d = Point_OBB(oneCenter, two);
+		const SphereCollider::WorldCache& w = one->GetWorld();
+		Data d = Point_OBB(w.center, two);
 		if (!d.collision) {
-			d.collision = glm::distance(oneCenter, d.closestPoint) < one->GetRadius() * one->GetRadius();
+			float dist = glm::distance(w.center, d.closestPoint);
+			d.collision = dist <= w.radius;
+			if (d.collision) {
+				d.normal = dist > 0.0f ? (d.closestPoint - w.center) / dist : glm::vec3(0, -1, 0);
+				d.depth = w.radius - dist;
+			}
+		}
+		else {
+			//Center inside the box, push out through the nearest face.
+			const BoundingBoxCollider::WorldCache& b = two->GetWorld();
+			glm::vec3 local = w.center - b.center;
+			float best = FLT_MAX;
+			for (int i = 0; i < 3; ++i) {
+				float proj = glm::dot(local, b.axis[i]);
+				float gap = b.halfSize[i] - fabsf(proj);
+				if (gap < best) {
+					best = gap;
+					d.normal = b.axis[i] * (proj > 0.0f ? -1.0f : 1.0f);
+				}
+			}
+			d.depth = w.radius + best;
 		}
 		return d;
 	}
@@ -428,10 +517,38 @@ public:
 	/// <param name="two">A SphereCollider</param>
 	/// <returns>The Data of the collision.</returns>
 	static Data Sphere_Sphere(SphereCollider* one, SphereCollider* two) {
-		float dist = glm::distance(one->GetCenter(), two->GetCenter());
-		float sum = one->GetRadius() + two->GetRadius();
-		glm::vec3 n = glm::normalize(two->GetCenter() - one->GetCenter());
-		return Data(dist <= sum, n * (float)one->GetRadius());
+		const SphereCollider::WorldCache& w1 = one->GetWorld();
+		const SphereCollider::WorldCache& w2 = two->GetWorld();
+		float dist = glm::distance(w1.center, w2.center);
+		float sum = w1.radius + w2.radius;
+		glm::vec3 n = dist > 0.0f ? (w2.center - w1.center) / dist : glm::vec3(0, 1, 0);
+		return Data(dist <= sum, w1.center + n * w1.radius, n, sum - dist);
+	}
+
+	/// <summary>
+	/// Compute collision for two convex colliders with GJK, and the penetration with EPA.
+	/// </summary>
+	/// <param name="one">A collider</param>
+	/// <param name="two">A collider</param>
+	/// <param name="simplex">The simplex of the last test of the pair, to warm start the GJK (updated)</param>
+	/// <returns>The Data of the collision, the closest point is the deepest point of two.</returns>
+	static Data Convex_Convex(ICollider* one, ICollider* two, GJK::Simplex& simplex) {
+		GJK::Result r = GJK::Penetration(one, two, simplex);
+		if (!r.intersect) {
+			return Data(false, glm::vec3(0));
+		}
+		return Data(true, two->Support(-r.normal), r.normal, r.depth);
+	}
+
+	/// <summary>
+	/// Compute collision for two convex colliders with GJK, and the penetration with EPA.
+	/// </summary>
+	/// <param name="one">A collider</param>
+	/// <param name="two">A collider</param>
+	/// <returns>The Data of the collision, the closest point is the deepest point of two.</returns>
+	static Data Convex_Convex(ICollider* one, ICollider* two) {
+		GJK::Simplex simplex;
+		return Convex_Convex(one, two, simplex);
 	}
 
 	// --- Points ---
@@ -478,13 +595,13 @@ public:
 		bool collision = true;
 		glm::vec3 closestPoint = one;
 
-		glm::mat3 orientation(two->attachment->GetTransform()->getRotationMatrix());
-		closestPoint = two->GetCenter();
-		glm::vec3 halfSize = two->GetHalfSize();
+		const BoundingBoxCollider::WorldCache& w = two->GetWorld();
+		closestPoint = w.center;
+		glm::vec3 halfSize = w.halfSize;
 		glm::vec3 dir = one - closestPoint;
 
 		for (int i = 0; i < 3; ++i) {
-			glm::vec3 axis(orientation[i][0], orientation[i][1], orientation[i][2]);
+			glm::vec3 axis = w.axis[i];
 			float dist = glm::dot(dir, axis);
 			if (dist > halfSize[i]) {
 				dist = halfSize[i];
@@ -507,8 +624,9 @@ public:
 	/// <param name="two">A SphereCollider.</param>
 	/// <returns>The Data of the collision.</returns>
 	static Data Point_Sphere(glm::vec3 one, SphereCollider* two) {
-		bool collision = glm::distance(one, two->GetCenter()) <= two->GetRadius();
-		glm::vec3 closestPoint = glm::normalize(one - two->GetCenter()) * (float)two->GetRadius();
+		const SphereCollider::WorldCache& w = two->GetWorld();
+		bool collision = glm::distance(one, w.center) <= w.radius;
+		glm::vec3 closestPoint = glm::normalize(one - w.center) * w.radius;
 		return Data(collision, closestPoint);
 	}
 
@@ -520,12 +638,14 @@ public:
 	/// <param name="bb">Bounding box</param>
 	/// <returns>The lenght of the ray, if -1 : ray do not hit</returns>
 	static double Ray_AABB(glm::vec3 origin, glm::vec3 direction, BoundingBoxCollider* bb) {
-		double t1 = (bb->GetMin().x - origin.x) / (EpsilonCompare(direction.x, 0.0f) ? 0.00001f : direction.x);
-		double t2 = (bb->GetMax().x - origin.x) / (EpsilonCompare(direction.x, 0.0f) ? 0.00001f : direction.x);
-		double t3 = (bb->GetMin().y - origin.y) / (EpsilonCompare(direction.y, 0.0f) ? 0.00001f : direction.y);
-		double t4 = (bb->GetMax().y - origin.y) / (EpsilonCompare(direction.y, 0.0f) ? 0.00001f : direction.y);
-		double t5 = (bb->GetMin().z - origin.z) / (EpsilonCompare(direction.z, 0.0f) ? 0.00001f : direction.z);
-		double t6 = (bb->GetMax().z - origin.z) / (EpsilonCompare(direction.z, 0.0f) ? 0.00001f : direction.z);
+		glm::vec3 min, max;
+		bb->GetMinMax(min, max);
+		double t1 = (min.x - origin.x) / (EpsilonCompare(direction.x, 0.0f) ? 0.00001f : direction.x);
+		double t2 = (max.x - origin.x) / (EpsilonCompare(direction.x, 0.0f) ? 0.00001f : direction.x);
+		double t3 = (min.y - origin.y) / (EpsilonCompare(direction.y, 0.0f) ? 0.00001f : direction.y);
+		double t4 = (max.y - origin.y) / (EpsilonCompare(direction.y, 0.0f) ? 0.00001f : direction.y);
+		double t5 = (min.z - origin.z) / (EpsilonCompare(direction.z, 0.0f) ? 0.00001f : direction.z);
+		double t6 = (max.z - origin.z) / (EpsilonCompare(direction.z, 0.0f) ? 0.00001f : direction.z);
 
 		double tmin = fmaxf(fmaxf(fminf(t1, t2), fminf(t3, t4)), fminf(t5, t6));
 		double tmax = fminf(fminf(fmaxf(t1, t2), fmaxf(t3, t4)), fmaxf(t5, t6));
@@ -575,24 +695,196 @@ public:
 	/// <param name="t">The triangle</param>
 	/// <returns>The lenght of the ray, if -1 : ray do not hit</returns>
 	static double Ray_Triangle(glm::vec3 origin, glm::vec3 direction, Triangle t) {
-		glm::vec3 n = glm::normalize(glm::cross(t[1] - t[0], t[2] - t[0]));
-		Plane p(n, glm::dot(n, t[0]));
-		double val = CollisionDetection::Ray_Plane(origin, direction, p);
-		if (val < 0.0) {
+		glm::vec3 barycentric;
+		return Ray_Triangle(origin, direction, t, barycentric);
+	}
+
+	/// <summary>
+	/// Compute the lenght of a ray and a Triangle (Moller-Trumbore), if -1 ray do not hit
+	/// </summary>
+	/// <param name="origin">Origin of the ray</param>
+	/// <param name="direction">Direction of the ray</param>
+	/// <param name="t">The triangle</param>
+	/// <param name="barycentric">The barycentric coordinates of the hit (output)</param>
+	/// <returns>The lenght of the ray, if -1 : ray do not hit</returns>
+	static double Ray_Triangle(glm::vec3 origin, glm::vec3 direction, Triangle t, glm::vec3& barycentric) {
+		glm::vec3 e1 = t[1] - t[0];
+		glm::vec3 e2 = t[2] - t[0];
+		glm::vec3 p = glm::cross(direction, e2);
+		float det = glm::dot(e1, p);
+		if (det == 0.0f) {
 			return -1.0;
 		}
 
-		glm::vec3 barycentre = Barycentric(origin + (direction * (float)val), t);
-		if (barycentre.x >= 0.0f && barycentre.x <= 1.0f &&
-			barycentre.y >= 0.0f && barycentre.y <= 1.0f &&
-			barycentre.z >= 0.0f && barycentre.z <= 1.0f) {
+		float invDet = 1.0f / det;
+		glm::vec3 s = origin - t[0];
+		float u = glm::dot(s, p) * invDet;
+		if (u < 0.0f || u > 1.0f) {
+			return -1.0;
+		}
 
-			return val;
+		glm::vec3 q = glm::cross(s, e1);
+		float v = glm::dot(direction, q) * invDet;
+		if (v < 0.0f || u + v > 1.0f) {
+			return -1.0;
 		}
 
-		return -1.0;
+		float val = glm::dot(e2, q) * invDet;
+		if (val < 0.0f) {
+			return -1.0;
+		}
+
+		barycentric = glm::vec3(1.0f - u - v, u, v);
+		return val;
+	}
+
+
+	// --- Time of impact ---
+
+	/// <summary>
+	/// Compute the time of impact of a segment entering an AABB, if -1 the segment do not enter the box (or start inside it).
+	/// </summary>
+	/// <param name="origin">Start of the segment</param>
+	/// <param name="displacement">The segment, from the start to the end</param>
+	/// <param name="min">Min of the box</param>
+	/// <param name="max">Max of the box</param>
+	/// <param name="normal">The normal of the entered face, set if hit</param>
+	/// <returns>The fraction of the displacement in [0, 1] where the segment enter the box, -1 if none</returns>
+	static double Segment_AABB(glm::vec3 origin, glm::vec3 displacement, glm::vec3 min, glm::vec3 max, glm::vec3& normal) {
+		float tmin = -std::numeric_limits<float>::max();
+		float tmax = std::numeric_limits<float>::max();
+		int axis = 0;
+		for (int i = 0; i < 3; i++) {
+			if (displacement[i] == 0.0f) {
+				if (origin[i] < min[i] || origin[i] > max[i]) {
+					return -1.0;
+				}
+				continue;
+			}
+			float inv = 1.0f / displacement[i];
+			float t1 = (min[i] - origin[i]) * inv;
+			float t2 = (max[i] - origin[i]) * inv;
+			if (fminf(t1, t2) > tmin) {
+				tmin = fminf(t1, t2);
+				axis = i;
+			}
+			tmax = fminf(tmax, fmaxf(t1, t2));
+		}
+
+		if (tmin > tmax || tmin < 0.0f || tmin > 1.0f) {
+			return -1.0;
+		}
+		normal = glm::vec3(0);
+		normal[axis] = displacement[axis] > 0.0f ? -1.0f : 1.0f;
+		return tmin;
+	}
+
+	/// <summary>
+	/// Compute the time of impact of a moving sphere with a sphere, if -1 they do not collide during the move (or already collide).
+	/// </summary>
+	/// <param name="one">The moving sphere</param>
+	/// <param name="displacement">The displacement of one during the step</param>
+	/// <param name="two">The static sphere</param>
+	/// <param name="normal">The normal of the contact, from two to one, set if hit</param>
+	/// <returns>The fraction of the displacement in [0, 1] of the first contact, -1 if none</returns>
+	static double Sweep_Sphere_Sphere(SphereCollider* one, glm::vec3 displacement, SphereCollider* two, glm::vec3& normal) {
+		const SphereCollider::WorldCache& w1 = one->GetWorld();
+		const SphereCollider::WorldCache& w2 = two->GetWorld();
+		glm::vec3 m = w1.center - w2.center;
+		float r = w1.radius + w2.radius;
+
+		float a = glm::dot(displacement, displacement);
+		float b = glm::dot(m, displacement);
+		float c = glm::dot(m, m) - r * r;
+		if (c <= 0.0f || b >= 0.0f || a == 0.0f) {
+			return -1.0;
+		}
+
+		float discr = b * b - a * c;
+		if (discr < 0.0f) {
+			return -1.0;
+		}
+
+		float t = (-b - sqrtf(discr)) / a;
+		if (t > 1.0f) {
+			return -1.0;
+		}
+		normal = glm::normalize(m + displacement * t);
+		return t;
+	}
+
+	/// <summary>
+	/// Compute the time of impact of a moving sphere with an oriented box, if -1 they do not collide during the move (or already collide).
+	/// The sweep is done in the box space against the box grown by the radius, the rounded edges are approximated by the grown box.
+	/// </summary>
+	/// <param name="one">The moving sphere</param>
+	/// <param name="displacement">The displacement of one during the step</param>
+	/// <param name="two">The static box</param>
+	/// <param name="normal">The normal of the contact, from two to one, set if hit</param>
+	/// <returns>The fraction of the displacement in [0, 1] of the first contact, -1 if none</returns>
+	static double Sweep_Sphere_OBB(SphereCollider* one, glm::vec3 displacement, BoundingBoxCollider* two, glm::vec3& normal) {
+		const SphereCollider::WorldCache& ws = one->GetWorld();
+		const BoundingBoxCollider::WorldCache& wb = two->GetWorld();
+		glm::vec3 rel = ws.center - wb.center;
+		glm::vec3 origin = glm::vec3(glm::dot(rel, wb.axis[0]), glm::dot(rel, wb.axis[1]), glm::dot(rel, wb.axis[2]));
+		glm::vec3 move = glm::vec3(glm::dot(displacement, wb.axis[0]), glm::dot(displacement, wb.axis[1]), glm::dot(displacement, wb.axis[2]));
+		glm::vec3 extent = wb.halfSize + glm::vec3(ws.radius);
+		glm::vec3 n;
+		double t = Segment_AABB(origin, move, -extent, extent, n);
+		if (t >= 0.0) {
+			normal = wb.axis[0] * n.x + wb.axis[1] * n.y + wb.axis[2] * n.z;
+		}
+		return t;
+	}
+
+	/// <summary>
+	/// Compute the time of impact of two moving AABB, if -1 they do not collide during the move (or already collide).
+	/// </summary>
+	/// <param name="minOne">Min of the moving box</param>
+	/// <param name="maxOne">Max of the moving box</param>
+	/// <param name="displacement">The displacement of the first box during the step</param>
+	/// <param name="minTwo">Min of the static box</param>
+	/// <param name="maxTwo">Max of the static box</param>
+	/// <param name="normal">The normal of the contact, from two to one, set if hit</param>
+	/// <returns>The fraction of the displacement in [0, 1] of the first contact, -1 if none</returns>
+	static double Sweep_AABB_AABB(glm::vec3 minOne, glm::vec3 maxOne, glm::vec3 displacement, glm::vec3 minTwo, glm::vec3 maxTwo, glm::vec3& normal) {
+		glm::vec3 half = (maxOne - minOne) * 0.5f;
+		return Segment_AABB((minOne + maxOne) * 0.5f, displacement, minTwo - half, maxTwo + half, normal);
+	}
+
+	/// <summary>
+	/// Compute the time of impact of a collider moving with its world AABB, if -1 they do not collide during the move (or already collide).
+	/// </summary>
+	/// <param name="one">The moving collider</param>
+	/// <param name="displacement">The displacement of one during the step</param>
+	/// <param name="two">The static collider</param>
+	/// <param name="normal">The normal of the contact, from two to one, set if hit</param>
+	/// <returns>The fraction of the displacement in [0, 1] of the first contact, -1 if none</returns>
+	static double Sweep_AABB_AABB(ICollider* one, glm::vec3 displacement, ICollider* two, glm::vec3& normal) {
+		glm::vec3 min1, max1, min2, max2;
+		one->GetWorldBounds(min1, max1);
+		two->GetWorldBounds(min2, max2);
+		return Sweep_AABB_AABB(min1, max1, displacement, min2, max2, normal);
 	}
 
+	/// <summary>
+	/// Compute the time of impact of a moving collider with another one, depending on the collider types.
+	/// A sphere is swept against a sphere or in the space of an oriented box, the other cases use the world AABB.
+	/// </summary>
+	/// <param name="one">The moving collider</param>
+	/// <param name="displacement">The displacement of one during the step</param>
+	/// <param name="two">The static collider</param>
+	/// <param name="normal">The normal of the contact, from two to one, set if hit</param>
+	/// <returns>The fraction of the displacement in [0, 1] of the first contact, -1 if none</returns>
+	static double TimeOfImpact(ICollider* one, glm::vec3 displacement, ICollider* two, glm::vec3& normal) {
+		if (one->ColliderType() == ICollider::Sphere && two->ColliderType() == ICollider::Sphere) {
+			return Sweep_Sphere_Sphere(static_cast<SphereCollider*>(one), displacement, static_cast<SphereCollider*>(two), normal);
+		}
+		else if (one->ColliderType() == ICollider::Sphere && two->ColliderType() == ICollider::BoundingBox) {
+			return Sweep_Sphere_OBB(static_cast<SphereCollider*>(one), displacement, static_cast<BoundingBoxCollider*>(two), normal);
+		}
+		return Sweep_AABB_AABB(one, displacement, two, normal);
+	}
 
 	// --- Intervales ---
 
@@ -620,10 +912,11 @@ public:
 	/// <param name="oriented">If the bounding box is oriented.</param>
 	/// <returns>The interval of the axis</returns>
 	static glm::vec2 GetInterval(BoundingBoxCollider* one, glm::vec3 axis, bool oriented) {
+		const BoundingBoxCollider::WorldCache& w = one->GetWorld();
 		glm::vec3 v[8];
 		if (!oriented) {
-			glm::vec3 i = one->GetMin();
-			glm::vec3 a = one->GetMax();
+			glm::vec3 i = w.min;
+			glm::vec3 a = w.max;
 
 			v[0] = glm::vec3(i.x, a.y, a.z);
 			v[1] = glm::vec3(i.x, a.y, i.z);
@@ -635,24 +928,9 @@ public:
 			v[7] = glm::vec3(a.x, i.y, i.z);
 		}
 		else {
-			glm::vec3 center = one->GetCenterOriented();
-			glm::vec3 size = one->GetHalfSize();
-			glm::mat4 orientation = one->attachment->GetTransform()->getRotationMatrix();
-
-			glm::vec3 a[] = {
-				glm::vec3(orientation[0][0], orientation[0][1], orientation[0][2]),
-				glm::vec3(orientation[1][0], orientation[1][1], orientation[1][2]),
-				glm::vec3(orientation[2][0], orientation[2][1], orientation[2][2]),
-			};
-
-			v[0] = center + a[0] * size[0] + a[1] * size[1] + a[2] * size[2];
-			v[1] = center - a[0] * size[0] + a[1] * size[1] + a[2] * size[2];
-			v[2] = center + a[0] * size[0] - a[1] * size[1] + a[2] * size[2];
-			v[3] = center + a[0] * size[0] + a[1] * size[1] - a[2] * size[2];
-			v[4] = center - a[0] * size[0] - a[1] * size[1] - a[2] * size[2];
-			v[5] = center + a[0] * size[0] - a[1] * size[1] - a[2] * size[2];
-			v[6] = center - a[0] * size[0] + a[1] * size[1] - a[2] * size[2];
-			v[7] = center - a[0] * size[0] - a[1] * size[1] + a[2] * size[2];
+			for (int i = 0; i < 8; ++i) {
+				v[i] = w.corners[i];
+			}
 		}
 
 		glm::vec2 res(glm::dot(axis, v[0]));
@@ -698,6 +976,20 @@ public:
 		return ((b.x <= a.y) && (a.x <= b.y));
 	}
 
+	/// <summary>
+	/// Compute the penetration of two Bounding box along an axis.
+	/// </summary>
+	/// <param name="one">A BoundingBoxCollider object.</param>
+	/// <param name="two">A BoundingBoxCollider object.</param>
+	/// <param name="axis">The normalized Axis.</param>
+	/// <param name="mode">The bounding Box mode of the two bouding box</param>
+	/// <returns>The length of the overlap, negative if the axis separate the two boxes</returns>
+	static float AxisPenetration(BoundingBoxCollider* one, BoundingBoxCollider* two, glm::vec3 axis, BBMode mode) {
+		glm::vec2 a = GetInterval(one, axis, mode == M_OBB_OBB || mode == M_OBB_AABB);
+		glm::vec2 b = GetInterval(two, axis, mode == M_OBB_OBB || mode == M_AABB_OBB);
+		return fminf(a.y, b.y) - fmaxf(a.x, b.x);
+	}
+
 	/// <summary>
 	/// Compute the axis overlap between a Bounding box and a triangle.
 	/// </summary>
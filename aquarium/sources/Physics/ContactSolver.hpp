@@ -0,0 +1,344 @@
+#ifndef __CONTACT_SOLVER_HPP__
+#define __CONTACT_SOLVER_HPP__
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include <Engine/Tools/JobPool.hpp>
+#include <Physics/PairCache.hpp>
+#include <Physics/Physics/Rigidbody.hpp>
+
+/// <summary>
+/// Contact solver, resolve the colliding pairs with sequential impulses.
+/// The touching bodies are grouped in islands (union find), each island is independent and solved as a job of the JobPool.
+/// An island where every body is at rest goes to sleep, and is not solved while nothing wakes it up: an awake body,
+/// or a static or kinematic collider that moved or started touching it.
+/// </summary>
+class ContactSolver {
+public:
+
+	/// <summary>
+	/// A contact between two bodies, one of them can be static (nullptr or mass 0).
+	/// </summary>
+	struct Contact {
+		/// <param name="one">The first body.</param>
+		/// <param name="two">The second body.</param>
+		/// <param name="normal">The normal, from one to two.</param>
+		/// <param name="depth">The penetration depth.</param>
+		/// <param name="normalImpulse">The accumulated normal impulse.</param>
+		/// <param name="tangentImpulse">The accumulated friction impulse on the 2 tangents.</param>
+		Rigidbody* one;
+		Rigidbody* two;
+		glm::vec3 normal;
+		float depth;
+		glm::vec3 tangent[2];
+		float normalImpulse = 0.0f;
+		float tangentImpulse[2] = { 0.0f, 0.0f };
+		float bias = 0.0f;
+		float bounce = 0.0f;
+		bool disturbed = false; // the static side moved, or touch the body since this step
+	};
+
+	/// <summary>
+	/// A group of bodies touching each other, with their contacts.
+	/// </summary>
+	struct Island {
+		std::vector<Rigidbody*> bodies;
+		std::vector<size_t> contacts;
+		bool sleeping = true;
+	};
+
+protected:
+	int iterations = 8;
+	float restitution = 0.2f;
+	float friction = 0.4f;
+
+	//Under this approach speed the contacts do not bounce, avoid jittering of the resting bodies.
+	float bounceVelocity = 0.5f;
+
+	//Position correction (Baumgarte), fraction of the penetration removed per second and tolerated penetration.
+	float baumgarte = 0.2f;
+	float slop = 0.005f;
+
+	std::vector<Contact> contacts;
+	std::vector<Island> islands;
+
+	//The world version of the static and kinematic colliders touching a body, on the last step and on this one.
+	std::unordered_map<ICollider*, uint64_t> staticVersions;
+	std::unordered_map<ICollider*, uint64_t> currentStaticVersions;
+
+	//Union find
+	std::unordered_map<Rigidbody*, int> bodyIndex;
+	std::vector<Rigidbody*> bodies;
+	std::vector<int> parent;
+
+public:
+
+	/// <summary>
+	/// Solve the contacts of the colliding pairs, trigger colliders are ignored.
+	/// </summary>
+	/// <param name="pairs">The colliding pairs</param>
+	/// <param name="delta">Time of the step</param>
+	/// <param name="pool">The job pool for the islands, nullptr to solve on the calling thread</param>
+	void Solve(const std::vector<PairCache::Pair*>& pairs, double delta, JobPool* pool) {
+		this->contacts.clear();
+		this->islands.clear();
+		this->bodyIndex.clear();
+		this->bodies.clear();
+		this->parent.clear();
+
+		if (delta <= 0.0) {
+			return;
+		}
+
+		BuildContacts(pairs, (float)delta);
+		this->staticVersions.swap(this->currentStaticVersions);
+		this->currentStaticVersions.clear();
+		BuildIslands();
+
+		std::vector<Island*> active;
+		for (Island& island : this->islands) {
+			if (!island.sleeping) {
+				active.push_back(&island);
+			}
+		}
+
+		if (pool != nullptr) {
+			pool->ParallelFor(active.size(), 1, [&](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					SolveIsland(*active[i]);
+				}
+			});
+		}
+		else {
+			for (Island* island : active) {
+				SolveIsland(*island);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Return the islands of the last step.
+	/// </summary>
+	/// <returns>The islands</returns>
+	const std::vector<Island>& GetIslands() {
+		return this->islands;
+	}
+
+	/// <summary>
+	/// Return the contacts of the last step.
+	/// </summary>
+	/// <returns>The contacts</returns>
+	const std::vector<Contact>& GetContacts() {
+		return this->contacts;
+	}
+
+	/// <summary>
+	/// Set the number of iterations of the solver.
+	/// </summary>
+	/// <param name="iterations">The number of iterations</param>
+	void SetIterations(int iterations) {
+		this->iterations = iterations;
+	}
+
+protected:
+
+	/// <summary>
+	/// Return the dynamic rigidbody of a collider, nullptr if static.
+	/// </summary>
+	static Rigidbody* GetBody(ICollider* collider) {
+		Rigidbody* r = collider->attachment->getFirstComponentByType<Rigidbody>();
+		return (r != nullptr && r->IsDynamic()) ? r : nullptr;
+	}
+
+	/// <summary>
+	/// Create the contacts from the colliding pairs, and register the dynamic bodies.
+	/// </summary>
+	void BuildContacts(const std::vector<PairCache::Pair*>& pairs, float delta) {
+		for (PairCache::Pair* p : pairs) {
+			if (p->one->IsTrigger() || p->two->IsTrigger()) {
+				continue;
+			}
+			Rigidbody* one = GetBody(p->one);
+			Rigidbody* two = GetBody(p->two);
+			if (one == nullptr && two == nullptr) {
+				continue;
+			}
+			if (glm::dot(p->data.normal, p->data.normal) < 0.5f) { // No contact normal computed for this pair.
+				continue;
+			}
+
+			Contact c;
+			c.one = one;
+			c.two = two;
+			c.normal = p->data.normal;
+			c.depth = p->data.depth;
+			c.bias = this->baumgarte / delta * std::max(c.depth - this->slop, 0.0f);
+
+			glm::vec3 v1 = one != nullptr ? one->GetVelocity() : glm::vec3(0);
+			glm::vec3 v2 = two != nullptr ? two->GetVelocity() : glm::vec3(0);
+			float approach = glm::dot(v2 - v1, c.normal);
+			c.bounce = approach < -this->bounceVelocity ? -this->restitution * approach : 0.0f;
+
+			glm::vec3 ref = fabsf(c.normal.x) < 0.9f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+			c.tangent[0] = glm::normalize(glm::cross(c.normal, ref));
+			c.tangent[1] = glm::cross(c.normal, c.tangent[0]);
+
+			//A static or kinematic collider that moved, or a new one, wakes the island.
+			for (ICollider* side : { one == nullptr ? p->one : nullptr, two == nullptr ? p->two : nullptr }) {
+				if (side == nullptr) {
+					continue;
+				}
+				uint64_t version = side->GetWorldVersion();
+				auto last = this->staticVersions.find(side);
+				c.disturbed |= last == this->staticVersions.end() || last->second != version;
+				this->currentStaticVersions[side] = version;
+			}
+
+			int i1 = Register(one);
+			int i2 = Register(two);
+			if (i1 >= 0 && i2 >= 0) {
+				Union(i1, i2);
+			}
+			this->contacts.push_back(c);
+		}
+	}
+
+	/// <summary>
+	/// Add a body to the union find, return its index (-1 for a static body).
+	/// </summary>
+	int Register(Rigidbody* body) {
+		if (body == nullptr) {
+			return -1;
+		}
+		auto it = this->bodyIndex.find(body);
+		if (it != this->bodyIndex.end()) {
+			return it->second;
+		}
+		int index = (int)this->bodies.size();
+		this->bodyIndex[body] = index;
+		this->bodies.push_back(body);
+		this->parent.push_back(index);
+		return index;
+	}
+
+	int Find(int i) {
+		while (this->parent[i] != i) {
+			this->parent[i] = this->parent[this->parent[i]];
+			i = this->parent[i];
+		}
+		return i;
+	}
+
+	void Union(int a, int b) {
+		a = Find(a);
+		b = Find(b);
+		if (a != b) {
+			this->parent[std::max(a, b)] = std::min(a, b);
+		}
+	}
+
+	/// <summary>
+	/// Group the bodies and contacts by island, and decide the sleep state of each island.
+	/// </summary>
+	void BuildIslands() {
+		std::vector<int> rootIsland(this->bodies.size(), -1);
+		for (size_t i = 0, max = this->bodies.size(); i < max; i++) {
+			int root = Find((int)i);
+			if (rootIsland[root] < 0) {
+				rootIsland[root] = (int)this->islands.size();
+				this->islands.push_back(Island());
+			}
+			int island = rootIsland[root];
+			this->islands[island].bodies.push_back(this->bodies[i]);
+			this->bodies[i]->SetIsland(island);
+		}
+
+		for (size_t i = 0, max = this->contacts.size(); i < max; i++) {
+			Rigidbody* body = this->contacts[i].one != nullptr ? this->contacts[i].one : this->contacts[i].two;
+			this->islands[body->GetIsland()].contacts.push_back(i);
+		}
+
+		for (Island& island : this->islands) {
+			bool disturbed = false;
+			for (size_t ci : island.contacts) {
+				disturbed |= this->contacts[ci].disturbed;
+			}
+			bool anyAwake = disturbed;
+			bool allResting = !disturbed;
+			for (Rigidbody* b : island.bodies) {
+				anyAwake |= !b->IsSleeping();
+				allResting &= b->IsSleeping() || b->CanSleep();
+			}
+
+			if (!anyAwake) {
+				island.sleeping = true;
+			}
+			else if (allResting) {
+				for (Rigidbody* b : island.bodies) {
+					b->Sleep();
+				}
+				island.sleeping = true;
+			}
+			else {
+				//An awake body or a moving collider touch the island, everything must move again.
+				for (Rigidbody* b : island.bodies) {
+					if (b->IsSleeping()) {
+						b->WakeUp();
+					}
+				}
+				island.sleeping = false;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Sequential impulses on the contacts of one island.
+	/// </summary>
+	void SolveIsland(Island& island) {
+		for (int it = 0; it < this->iterations; it++) {
+			for (size_t ci : island.contacts) {
+				Contact& c = this->contacts[ci];
+				float im1 = c.one != nullptr ? c.one->GetInverseMass() : 0.0f;
+				float im2 = c.two != nullptr ? c.two->GetInverseMass() : 0.0f;
+				float imSum = im1 + im2;
+				if (imSum <= 0.0f) {
+					continue;
+				}
+
+				glm::vec3 v1 = c.one != nullptr ? c.one->GetVelocity() : glm::vec3(0);
+				glm::vec3 v2 = c.two != nullptr ? c.two->GetVelocity() : glm::vec3(0);
+				glm::vec3 rel = v2 - v1;
+
+				//Normal impulse, the accumulated impulse stay positive (no attraction).
+				float vn = glm::dot(rel, c.normal);
+				float target = std::max(c.bounce, c.bias);
+				float lambda = (target - vn) / imSum;
+				float old = c.normalImpulse;
+				c.normalImpulse = std::max(old + lambda, 0.0f);
+				glm::vec3 impulse = c.normal * (c.normalImpulse - old);
+
+				//Friction, bounded by the normal impulse.
+				for (int t = 0; t < 2; t++) {
+					float vt = glm::dot(rel, c.tangent[t]);
+					float lt = -vt / imSum;
+					float maxFriction = this->friction * c.normalImpulse;
+					float oldT = c.tangentImpulse[t];
+					c.tangentImpulse[t] = glm::clamp(oldT + lt, -maxFriction, maxFriction);
+					impulse += c.tangent[t] * (c.tangentImpulse[t] - oldT);
+				}
+
+				if (c.one != nullptr) {
+					c.one->ApplySolverVelocity(v1 - impulse * im1);
+				}
+				if (c.two != nullptr) {
+					c.two->ApplySolverVelocity(v2 + impulse * im2);
+				}
+			}
+		}
+	}
+};
+
+#endif // !__CONTACT_SOLVER_HPP__
@@ -0,0 +1,434 @@
+#ifndef __GJK_HPP__
+#define __GJK_HPP__
+
+#include <vector>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include <Physics/Collider/ICollider.hpp>
+
+/// <summary>
+/// GJK distance and EPA penetration between two convex colliders, only using their support functions.
+/// The GJK work on the Minkowski difference one - two, the colliders intersect if it contains the origin.
+/// The simplex of a pair can be kept from a frame to another: it is rebuilt from the same support directions, so a coherent pair converges in one or two iterations.
+/// </summary>
+class GJK {
+public:
+
+	/// <summary>
+	/// A simplex of the Minkowski difference (1 to 4 points), with the support direction of each point to rebuild it on the next frame.
+	/// </summary>
+	struct Simplex {
+		glm::vec3 points[4];
+		glm::vec3 directions[4];
+		int count = 0;
+	};
+
+	/// <summary>
+	/// Result of a GJK / EPA query.
+	/// </summary>
+	struct Result {
+		/// <param name="intersect">If the colliders intersect.</param>
+		/// <param name="distance">The distance between the colliders, if they do not intersect (0 for an early out on a separating axis).</param>
+		/// <param name="normal">The penetration normal from one to two, if they intersect.</param>
+		/// <param name="depth">The penetration depth along the normal, if they intersect.</param>
+		/// <param name="iterations">The number of GJK iterations.</param>
+		bool intersect = false;
+		float distance = 0.0f;
+		glm::vec3 normal = glm::vec3(0);
+		float depth = 0.0f;
+		int iterations = 0;
+	};
+
+protected:
+	static const int MAX_ITERATIONS = 32;
+	static const int MAX_EPA_ITERATIONS = 64;
+
+	/// <summary>
+	/// A face of the EPA polytope, with its outward normal and its distance to the origin.
+	/// </summary>
+	struct Face {
+		int a, b, c;
+		glm::vec3 normal;
+		float distance;
+	};
+
+public:
+
+	/// <summary>
+	/// Return the support point of the Minkowski difference one - two in a direction.
+	/// </summary>
+	static glm::vec3 Support(ICollider* one, ICollider* two, glm::vec3 direction) {
+		return one->Support(direction) - two->Support(-direction);
+	}
+
+	/// <summary>
+	/// Test if two colliders intersect, stop as soon as a separating axis is found.
+	/// </summary>
+	/// <param name="one">The first collider</param>
+	/// <param name="two">The second collider</param>
+	/// <param name="simplex">The simplex of the last query of the pair (empty the first time), updated</param>
+	/// <returns>The result, without penetration</returns>
+	static Result Intersect(ICollider* one, ICollider* two, Simplex& simplex) {
+		return Run(one, two, simplex, true);
+	}
+
+	/// <summary>
+	/// Compute the distance between two colliders, 0 if they intersect.
+	/// </summary>
+	/// <param name="one">The first collider</param>
+	/// <param name="two">The second collider</param>
+	/// <param name="simplex">The simplex of the last query of the pair (empty the first time), updated</param>
+	/// <returns>The result, without penetration</returns>
+	static Result Distance(ICollider* one, ICollider* two, Simplex& simplex) {
+		return Run(one, two, simplex, false);
+	}
+
+	/// <summary>
+	/// Test if two colliders intersect and compute the penetration with the EPA.
+	/// </summary>
+	/// <param name="one">The first collider</param>
+	/// <param name="two">The second collider</param>
+	/// <param name="simplex">The simplex of the last query of the pair (empty the first time), updated</param>
+	/// <returns>The result, with the penetration normal and depth if they intersect</returns>
+	static Result Penetration(ICollider* one, ICollider* two, Simplex& simplex) {
+		Result res = Run(one, two, simplex, true);
+		if (res.intersect) {
+			EPA(one, two, simplex, res.normal, res.depth);
+		}
+		return res;
+	}
+
+protected:
+
+	/// <summary>
+	/// The GJK loop, from the warm started simplex.
+	/// </summary>
+	/// <param name="earlyOut">Stop on the first separating axis, without computing the distance</param>
+	static Result Run(ICollider* one, ICollider* two, Simplex& s, bool earlyOut) {
+		Result res;
+
+		//Rebuild the simplex of the last query at the current positions.
+		glm::vec3 directions[4];
+		int n = s.count;
+		for (int i = 0; i < n; i++) {
+			directions[i] = s.directions[i];
+		}
+		s.count = 0;
+		for (int i = 0; i < n; i++) {
+			Add(s, Support(one, two, directions[i]), directions[i]);
+		}
+		if (s.count == 0) {
+			glm::vec3 d = glm::vec3(1, 0, 0);
+			Add(s, Support(one, two, d), d);
+		}
+
+		for (res.iterations = 1; res.iterations <= MAX_ITERATIONS; res.iterations++) {
+			glm::vec3 v;
+			if (Reduce(s, v)) {
+				res.intersect = true;
+				return res;
+			}
+
+			float vv = glm::dot(v, v);
+			if (vv <= 1e-12f) {
+				//The origin is on the simplex, touching.
+				res.intersect = true;
+				return res;
+			}
+
+			glm::vec3 d = -v;
+			glm::vec3 p = Support(one, two, d);
+			float progress = vv - glm::dot(p, v);
+
+			if (earlyOut && glm::dot(p, d) < 0.0f) {
+				//d is a separating axis.
+				return res;
+			}
+			if (progress <= 1e-6f * vv || Contains(s, p)) {
+				//No point closer to the origin, v is the closest point of the difference.
+				res.distance = sqrtf(vv);
+				return res;
+			}
+			Add(s, p, d);
+		}
+
+		res.distance = 0.0f;
+		return res;
+	}
+
+	static void Add(Simplex& s, glm::vec3 point, glm::vec3 direction) {
+		s.points[s.count] = point;
+		s.directions[s.count] = direction;
+		s.count++;
+	}
+
+	static bool Contains(const Simplex& s, glm::vec3 p) {
+		for (int i = 0; i < s.count; i++) {
+			glm::vec3 d = s.points[i] - p;
+			if (glm::dot(d, d) <= 1e-12f) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Find the point of the simplex closest to the origin, and keep only the points of the feature containing it.
+	/// The search does not rely on the order of the points, so a rebuilt simplex is handled as a new one.
+	/// </summary>
+	/// <param name="s">The simplex, reduced</param>
+	/// <param name="v">The closest point (output)</param>
+	/// <returns>Is the origin inside the tetrahedron ?</returns>
+	static bool Reduce(Simplex& s, glm::vec3& v) {
+		float w[4] = { 0, 0, 0, 0 };
+
+		if (s.count == 1) {
+			w[0] = 1.0f;
+		}
+		else if (s.count == 2) {
+			Segment(s.points[0], s.points[1], w[0], w[1]);
+		}
+		else if (s.count == 3) {
+			Triangle(s.points[0], s.points[1], s.points[2], w[0], w[1], w[2]);
+		}
+		else {
+			static const int faces[4][4] = { { 1, 2, 3, 0 }, { 0, 3, 2, 1 }, { 0, 1, 3, 2 }, { 0, 2, 1, 3 } };
+			bool inside = true;
+			float best = FLT_MAX;
+			for (int f = 0; f < 4; f++) {
+				glm::vec3 a = s.points[faces[f][0]], b = s.points[faces[f][1]], c = s.points[faces[f][2]], d = s.points[faces[f][3]];
+				glm::vec3 normal = glm::cross(b - a, c - a);
+				float sideD = glm::dot(normal, d - a);
+				float sideO = glm::dot(normal, -a);
+				if (sideD != 0.0f && sideO * sideD >= 0.0f) {
+					continue;
+				}
+				inside = false;
+
+				float fw[3];
+				Triangle(a, b, c, fw[0], fw[1], fw[2]);
+				glm::vec3 p = a * fw[0] + b * fw[1] + c * fw[2];
+				float dist = glm::dot(p, p);
+				if (dist < best) {
+					best = dist;
+					w[0] = w[1] = w[2] = w[3] = 0.0f;
+					for (int k = 0; k < 3; k++) {
+						w[faces[f][k]] = fw[k];
+					}
+				}
+			}
+			if (inside) {
+				v = glm::vec3(0);
+				return true;
+			}
+		}
+
+		v = glm::vec3(0);
+		int count = 0;
+		for (int i = 0; i < s.count; i++) {
+			if (w[i] > 0.0f) {
+				v += s.points[i] * w[i];
+				s.points[count] = s.points[i];
+				s.directions[count] = s.directions[i];
+				count++;
+			}
+		}
+		s.count = count;
+		return false;
+	}
+
+	/// <summary>
+	/// Weights of the point of a segment closest to the origin.
+	/// </summary>
+	static void Segment(glm::vec3 a, glm::vec3 b, float& wa, float& wb) {
+		glm::vec3 ab = b - a;
+		float len = glm::dot(ab, ab);
+		float t = len > 0.0f ? glm::clamp(glm::dot(-a, ab) / len, 0.0f, 1.0f) : 0.0f;
+		wa = 1.0f - t;
+		wb = t;
+	}
+
+	/// <summary>
+	/// Weights of the point of a triangle closest to the origin, by Voronoi regions.
+	/// </summary>
+	static void Triangle(glm::vec3 a, glm::vec3 b, glm::vec3 c, float& wa, float& wb, float& wc) {
+		wa = wb = wc = 0.0f;
+		glm::vec3 ab = b - a, ac = c - a;
+
+		float d1 = glm::dot(ab, -a), d2 = glm::dot(ac, -a);
+		if (d1 <= 0.0f && d2 <= 0.0f) {
+			wa = 1.0f;
+			return;
+		}
+		float d3 = glm::dot(ab, -b), d4 = glm::dot(ac, -b);
+		if (d3 >= 0.0f && d4 <= d3) {
+			wb = 1.0f;
+			return;
+		}
+		float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+			wb = d1 / (d1 - d3);
+			wa = 1.0f - wb;
+			return;
+		}
+		float d5 = glm::dot(ab, -c), d6 = glm::dot(ac, -c);
+		if (d6 >= 0.0f && d5 <= d6) {
+			wc = 1.0f;
+			return;
+		}
+		float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+			wc = d2 / (d2 - d6);
+			wa = 1.0f - wc;
+			return;
+		}
+		float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+			wc = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			wb = 1.0f - wc;
+			return;
+		}
+
+		float sum = va + vb + vc;
+		if (sum <= 0.0f) {
+			//Flat triangle, closest point of its longest edge.
+			Segment(a, b, wa, wb);
+			return;
+		}
+		wb = vb / sum;
+		wc = vc / sum;
+		wa = 1.0f - wb - wc;
+	}
+
+	/// <summary>
+	/// Complete a simplex containing the origin to a tetrahedron, for the EPA.
+	/// </summary>
+	/// <returns>False if the Minkowski difference is flat</returns>
+	static bool BlowUp(ICollider* one, ICollider* two, Simplex& s) {
+		static const glm::vec3 axis[6] = { glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1) };
+		const float eps = 1e-6f;
+
+		if (s.count == 1) {
+			for (int i = 0; i < 6 && s.count == 1; i++) {
+				glm::vec3 p = Support(one, two, axis[i]);
+				if (glm::length(p - s.points[0]) > eps) {
+					Add(s, p, axis[i]);
+				}
+			}
+		}
+		if (s.count == 2) {
+			glm::vec3 line = s.points[1] - s.points[0];
+			for (int i = 0; i < 6 && s.count == 2; i++) {
+				glm::vec3 d = glm::cross(line, axis[i]);
+				if (glm::dot(d, d) <= eps) {
+					continue;
+				}
+				glm::vec3 p = Support(one, two, d);
+				if (glm::length(glm::cross(p - s.points[0], line)) > eps * glm::length(line)) {
+					Add(s, p, d);
+				}
+			}
+		}
+		if (s.count == 3) {
+			glm::vec3 normal = glm::cross(s.points[1] - s.points[0], s.points[2] - s.points[0]);
+			for (int sign = 1; sign >= -1 && s.count == 3; sign -= 2) {
+				glm::vec3 d = normal * (float)sign;
+				glm::vec3 p = Support(one, two, d);
+				if (fabsf(glm::dot(p - s.points[0], normal)) > eps * glm::length(normal)) {
+					Add(s, p, d);
+				}
+			}
+		}
+		return s.count == 4;
+	}
+
+	/// <summary>
+	/// Create a face of the polytope, oriented away from the inner point.
+	/// </summary>
+	static Face MakeFace(const std::vector<glm::vec3>& points, int a, int b, int c, glm::vec3 inner) {
+		glm::vec3 normal = glm::cross(points[b] - points[a], points[c] - points[a]);
+		if (glm::dot(normal, points[a] - inner) < 0.0f) {
+			std::swap(b, c);
+			normal = -normal;
+		}
+		float len = glm::length(normal);
+		Face f;
+		f.a = a;
+		f.b = b;
+		f.c = c;
+		f.normal = len > 0.0f ? normal / len : glm::vec3(0);
+		f.distance = len > 0.0f ? glm::dot(f.normal, points[a]) : FLT_MAX;
+		return f;
+	}
+
+	/// <summary>
+	/// Expanding Polytope Algorithm, grow the GJK tetrahedron toward the face of the Minkowski difference closest to the origin.
+	/// </summary>
+	/// <param name="normal">The penetration normal, from one to two (output)</param>
+	/// <param name="depth">The penetration depth (output)</param>
+	static void EPA(ICollider* one, ICollider* two, Simplex s, glm::vec3& normal, float& depth) {
+		normal = glm::vec3(0);
+		depth = 0.0f;
+		if (!BlowUp(one, two, s)) {
+			return;
+		}
+
+		std::vector<glm::vec3> points(s.points, s.points + 4);
+		glm::vec3 inner = (points[0] + points[1] + points[2] + points[3]) * 0.25f;
+		std::vector<Face> faces = { MakeFace(points, 0, 1, 2, inner), MakeFace(points, 0, 3, 1, inner), MakeFace(points, 0, 2, 3, inner), MakeFace(points, 1, 3, 2, inner) };
+		std::vector<std::pair<int, int>> edges;
+
+		for (int it = 0; it < MAX_EPA_ITERATIONS; it++) {
+			size_t closest = 0;
+			for (size_t i = 1, max = faces.size(); i < max; i++) {
+				if (faces[i].distance < faces[closest].distance) {
+					closest = i;
+				}
+			}
+			Face f = faces[closest];
+			normal = f.normal;
+			depth = f.distance;
+
+			glm::vec3 p = Support(one, two, f.normal);
+			if (glm::dot(p, f.normal) - f.distance < 1e-4f) {
+				return;
+			}
+
+			//Remove the faces seen from the new point, and keep their horizon.
+			int index = (int)points.size();
+			points.push_back(p);
+			edges.clear();
+			for (size_t i = 0; i < faces.size();) {
+				if (glm::dot(faces[i].normal, p - points[faces[i].a]) > 0.0f) {
+					int e[3][2] = { { faces[i].a, faces[i].b }, { faces[i].b, faces[i].c }, { faces[i].c, faces[i].a } };
+					for (int k = 0; k < 3; k++) {
+						auto reverse = std::find(edges.begin(), edges.end(), std::make_pair(e[k][1], e[k][0]));
+						if (reverse != edges.end()) {
+							edges.erase(reverse);
+						}
+						else {
+							edges.push_back(std::make_pair(e[k][0], e[k][1]));
+						}
+					}
+					faces[i] = faces.back();
+					faces.pop_back();
+				}
+				else {
+					i++;
+				}
+			}
+
+			for (const std::pair<int, int>& e : edges) {
+				faces.push_back(MakeFace(points, e.first, e.second, index, inner));
+			}
+			if (faces.empty()) {
+				return;
+			}
+		}
+	}
+};
+
+#endif // !__GJK_HPP__
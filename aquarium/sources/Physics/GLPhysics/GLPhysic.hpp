@@ -11,6 +11,7 @@ class GLPhysic : public CPhysic
 {
 protected:
     GLuint texture = -1;
+    bool derivedNormals = false;
 public:
     /// <summary>
     /// Graphics Physics Element
@@ -23,6 +24,13 @@ public:
     GLuint GetTexture(){
         return this->texture;
     }
+    /// <summary>
+    /// Return if the texture holds no normals, the shaders derive them from the heights (red channel).
+    /// </summary>
+    /// <returns>If the normals are derived</returns>
+    bool HasDerivedNormals(){
+        return this->derivedNormals;
+    }
 };
 
 #endif
\ No newline at end of file
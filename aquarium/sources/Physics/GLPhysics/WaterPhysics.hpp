@@ -5,44 +5,128 @@
 #include <string>
 #include <GL/glew.h>
 #include <vector>
+#include <algorithm>
+#include <unordered_map>
 #include <Physics/GLPhysics/GLPhysic.hpp>
 #include <Graphics/Framebuffer.hpp>
+#include <Graphics/PingPongBuffer.hpp>
+#include <Graphics/TextureCapture.hpp>
+#include <Physics/Physics/OceanSolver.hpp>
 #include <Engine/Shader.hpp>
 #include <Engine/Tools/ModelGenerator.hpp>
+#include <Physics/Collider/BoundingBoxCollider.hpp>
+#include <Physics/Collider/SphereCollider.hpp>
 
 
 /// <summary>
 /// The water physics Inherit GLPhysic.
 /// </summary>
 class WaterPhysics : public GLPhysic {
+public:
+	/// <summary>
+	/// The resolution tiers of the caustics, relative to the resolution of the water: x0.5, x1, x2, x4.
+	/// </summary>
+	enum CausticsQuality {
+		CAUSTICS_LOW,
+		CAUSTICS_MEDIUM,
+		CAUSTICS_HIGH,
+		CAUSTICS_ULTRA
+	};
 protected:
 	/// <summary>
-	/// Data of a drop of water.
+	/// Data of a drop of water, also the per instance data of the drop pass.
 	/// </summary>
 	struct Drop {
 		glm::vec2 pos;
 		float radius;
 		float strength;
-		Drop(glm::vec2 pos, float radius, float strength) {
+		Drop(glm::vec2 pos = glm::vec2(0), float radius = 0.0f, float strength = 0.0f) {
 			this->pos = pos;
 			this->radius = radius;
 			this->strength = strength;
 		}
 	};
+	/// <summary>
+	/// The shape of a collider on the water, in world units relative to the water center at rest.
+	/// </summary>
+	struct Shape {
+		glm::vec3 center;
+		glm::vec3 extent; // radius of the sphere or half size of the box
+		bool sphere;
+	};
+
+	/// <summary>
+	/// Per instance data of the footprint pass: a collider moving across the surface, from its previous to its current shape.
+	/// </summary>
+	struct Footprint {
+		glm::vec4 current; // center, shape (0 = sphere, 1 = box)
+		glm::vec4 previous; // center, strength
+		glm::vec4 extent; // radius or half size
+	};
+
 	Shader* physicShader; // the physic shader
-	Shader* dropShader; // the physic shader
+	Shader* dropShader; // the drop shader, one instanced quad per drop
+	Shader* footprintShader; // the footprint shader, one instanced quad per moving collider
 	Shader* causticShader; // the physic shader
-	Framebuffer framebuffer; // the framebuffer of this physic
-	Framebuffer causticFramebuffer; // the framebuffer of this physic
-	std::vector<Drop> drops; // list of drops to apply
+	PingPongBuffer state; // the water state (height, velocity, normal), read and written in turn by the passes. Compact (RG16F, no normal) when derivedNormals
+	Framebuffer causticFramebuffers[2]; // the two latest caustics (a single R8 target each), blended until the next update
+	int causticLatest = 0; // index of the latest caustics
+	CausticsQuality causticsQuality = CAUSTICS_ULTRA;
+	int causticsInterval = 1; // frames between two updates of the caustics
+	bool causticsOnDrop = true; // update the caustics as soon as a drop fell
+	int causticsAge = 0; // frames since the last update of the caustics
+	bool causticsPrimed = false; // the two caustics hold a result
+	std::vector<Drop> drops; // ring buffer of the drops to apply
+	size_t dropHead = 0; // index of the oldest queued drop
+	size_t dropCount = 0; // number of queued drops
+	GLuint splatVAO; // the drop pass vertex array
+	GLuint splatVBO[2]; // the quad corners, and the drops (one instance each)
+	float couplingStrength = 1.0f; // scale of the water displaced by the colliders (0 = no coupling)
+	std::unordered_map<ICollider*, Shape> colliderShapes; // the shapes of the colliders at the last frame
+	std::vector<Footprint> footprints; // the footprints of the frame
+	GLuint footprintVAO; // the footprint pass vertex array, on the quad corners of the drops
+	GLuint footprintVBO; // the footprints (one instance each)
+	Framebuffer displacement; // the height displaced by the footprints of the frame, consumed by the next step
+	bool displaced = false; // the displacement holds footprints to consume
 	int resolutionX, resolutionY; // the resolution of the texture
 	float invResX, invResY; // inverse of the resolution
 	glm::vec2 containerSize;
 	int frameForCapture = 5; // Debug element to capture what is going on.
+	TextureCapture capture; // the captures in flight, written without stalling the frame
 	int frameForCaptureCurrent = 6;
 
 
 	Model* quad; // the quad model to compute the physics
+
+	static const int COMPUTE_TILE = 16; // the work group size of Physics/water.comp
+	Shader* computeShader = nullptr; // the compute shader of the water, loaded with the compute mode
+	bool computeMode = false; // compute the water with the compute shader instead of the fragment pass
+	int substeps = 1; // number of water steps per frame in compute mode
+
+	static const int ACTIVE_TILE = 32; // the size of the tiles of the sparse mode, a multiple of COMPUTE_TILE
+	Shader* tileShader = nullptr; // choose the tiles computed in sparse mode, Physics/tiles.comp
+	bool sparseMode = false; // compute only the moving tiles of the water, in compute mode
+	float activityThreshold = 0.0005f; // height or velocity under which a tile is calm
+	int tileCountX = 0, tileCountY = 0; // the number of tiles
+	GLuint tileList = 0, tileEnergy = 0, tileForced = 0, tileSettle = 0, tileDispatch = 0; // the buffers of the sparse mode
+	std::vector<GLuint> forcedTiles; // the tiles under the drops of the frame
+	bool forcedChanged = false;
+
+	OceanSolver* ocean = nullptr; // the spectrum and the CPU FFT of the ocean mode, nullptr without the ocean mode
+	bool oceanGPU = true; // synthesize the ocean with the compute shaders, else with the CPU FFT
+	double oceanTime = 0.0; // the time of the waves
+	Shader* oceanShader = nullptr; // tile the patch over the water, Physics/ocean.frag
+	Shader* oceanSpectrumShader = nullptr; // Physics/ocean_spectrum.comp
+	Shader* oceanFFTShader = nullptr; // Physics/ocean_fft.comp
+	GLuint oceanInitial = 0, oceanPatch = 0, oceanScratch = 0; // h0, the patch (the spectrum then the waves), the FFT intermediate
+	std::vector<float> oceanUpload; // the patch synthesized on the CPU
+
+	bool heightQueries = false; // read the state back each frame for the CPU queries, turned on by the first query
+	bool heightQueriesSet = false; // set by SetHeightQueries, the queries do not turn the read back on
+	int heightLevel = 2; // mipmap level of the state read back, 0 = full resolution
+	int heightW = 0, heightH = 0; // the size of the state read back
+	std::vector<float> heights; // the latest state read back (RGBA, row by row), a frame or two late
+	TextureCapture heightReadback = TextureCapture(3); // the reads in flight, after the data they fill
 public:
 	/// <summary>
 	/// Create the water physics elements.
@@ -50,9 +134,11 @@ public:
 	/// <param name="resolutionX">The width of the texture</param>
 	/// <param name="resolutionY">The height of the texture</param>
 	/// <param name="containerSize">The size of the container, for computation.</param>
-	WaterPhysics(int resolutionX = 1024, int resolutionY = 1024, glm::vec2 containerSize = glm::vec2(1, 1)) {
+	/// <param name="maxDrops">The number of drops that can be queued for a frame, the oldest are replaced beyond.</param>
+	WaterPhysics(int resolutionX = 1024, int resolutionY = 1024, glm::vec2 containerSize = glm::vec2(1, 1), int maxDrops = 1024) {
 		this->physicShader = new Shader("Physics/water.vert", "Physics/water.frag");
-		this->dropShader = new Shader("Physics/water.vert", "Physics/drop.frag");
+		this->dropShader = new Shader("Physics/splat.vert", "Physics/drop.frag");
+		this->footprintShader = new Shader("Physics/footprint.vert", "Physics/footprint.frag");
 		this->causticShader = new Shader("caustics.vert", "caustics.frag");
 
 		this->resolutionX = resolutionX;
@@ -62,30 +148,39 @@ public:
 		this->quad = ModelGenerator::Quad(nullptr, resolutionX, resolutionY, 2, 2);
 		this->containerSize = containerSize;
 
-		float* data = new float[resolutionX * resolutionY * 4];
+		GenerateState();
 
-		for (int i = 0, max = this->resolutionX * this->resolutionY * 4; i < max; i++) {
-			data[i] = (i % 4 == 3 ? 1.0f : 0.0f);
-		}
+		this->drops.resize(std::max(maxDrops, 1));
+		GenerateSplat();
+		this->displacement.Generate(resolutionX, resolutionY, RenderTargetDesc::Color(GL_R16F));
+	}
 
-		glGenTextures(1, &this->texture);
-		glBindTexture(GL_TEXTURE_2D, this->texture);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, resolutionX, resolutionY, 0, GL_RGBA, GL_FLOAT, data);
+	/// <summary>
+	/// Destroy the water physics, and free the shaders, the solver of the ocean and the GPU data.
+	/// </summary>
+	~WaterPhysics() {
+		for (Shader* shader : { this->physicShader, this->dropShader, this->footprintShader, this->causticShader, this->computeShader, this->tileShader, this->oceanShader, this->oceanSpectrumShader, this->oceanFFTShader }) {
+			delete shader;
+		}
+		delete this->ocean;
+		delete this->quad;
 
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glDeleteVertexArrays(1, &this->splatVAO);
+		glDeleteBuffers(2, this->splatVBO);
+		glDeleteVertexArrays(1, &this->footprintVAO);
+		glDeleteBuffers(1, &this->footprintVBO);
 
-		delete data;
+		const GLuint tiles[5] = { this->tileList, this->tileEnergy, this->tileForced, this->tileSettle, this->tileDispatch };
+		glDeleteBuffers(5, tiles);
+		const GLuint textures[3] = { this->oceanInitial, this->oceanPatch, this->oceanScratch };
+		glDeleteTextures(3, textures);
 	}
 
 	/// <summary>
 	/// Wait the attachement of the gameobject to generate the framebuffer.
 	/// </summary>
 	void PostAttachment() override {
-		framebuffer.Generate(this->resolutionX, this->resolutionY, true);
-		causticFramebuffer.Generate(this->resolutionX*4, this->resolutionY*4);
+		GenerateCaustics();
 	}
 
 	/// <summary>
@@ -95,7 +190,223 @@ public:
 	/// <param name="radius">The radius of the drop</param>
 	/// <param name="strength">The power of the drop</param>
 	void AddDrop(glm::vec2 pos, float radius, float strength) {
-		this->drops.push_back(Drop(pos, radius, strength));
+		size_t capacity = this->drops.size();
+		if (this->dropCount == capacity) { // Full, the oldest drop is replaced.
+			this->dropHead = (this->dropHead + 1) % capacity;
+			this->dropCount--;
+		}
+		this->drops[(this->dropHead + this->dropCount) % capacity] = Drop(pos, radius, strength);
+		this->dropCount++;
+		ForceTiles(pos, radius);
+	}
+
+	/// <summary>
+	/// Set how much water the colliders moving across the surface push away, each frame their footprints are added to the height.
+	/// </summary>
+	/// <param name="strength">The scale of the displaced height (1 = the submerged volume, 0 = no coupling)</param>
+	void SetCouplingStrength(float strength) {
+		this->couplingStrength = strength;
+	}
+
+	/// <summary>
+	/// Store the state in a compact RG16F texture (height, velocity) instead of RGBA16F (height, velocity, normal): half the memory and the bandwidth of every pass on the state.
+	/// The normals are no longer written by the step, the shaders reading the state derive them from the neighbour heights. The water is reset flat.
+	/// </summary>
+	/// <param name="compact">Use the compact state ?</param>
+	void SetCompactState(bool compact) {
+		this->derivedNormals = compact;
+		GenerateState();
+		this->physicShader->DefineOverride(Shader::DataOverride(Shader::FRAGMENT, "COMPACT", compact ? "1" : "0"));
+		if (this->computeShader != nullptr) {
+			this->computeShader->DefineOverride(Shader::DataOverride(Shader::COMPUTE, "COMPACT", compact ? "1" : "0"));
+		}
+	}
+
+	/// <summary>
+	/// Compute the water with a compute shader: each work group load its tile in shared memory once, do all the substeps and the normals there.
+	/// </summary>
+	/// <param name="enabled">Use the compute shader ?</param>
+	/// <returns>If the compute mode is enabled (it needs OpenGL 4.3)</returns>
+	bool SetComputeMode(bool enabled) {
+		this->computeMode = enabled && GLEW_VERSION_4_3;
+		if (this->computeMode && this->computeShader == nullptr) {
+			this->computeShader = Shader::Compute("Physics/water.comp");
+			//Both defines at once, the shader is compiled a single time.
+			std::vector<Shader::DataOverride> defines;
+			defines.push_back(Shader::DataOverride(Shader::COMPUTE, "COMPACT", this->derivedNormals ? "1" : "0"));
+			defines.push_back(Shader::DataOverride(Shader::COMPUTE, "SUBSTEPS", std::to_string(this->substeps)));
+			this->computeShader->DefineOverride(defines);
+		}
+		if (!this->computeMode) {
+			SetSparseMode(false);
+		}
+		return this->computeMode;
+	}
+
+	/// <summary>
+	/// Compute only the tiles of the water that move (or are next to a moving tile, or under a drop), the calm tiles are flattened then skipped.
+	/// The tiles are chosen on the GPU each frame and the step is dispatched indirectly, so a calm water costs almost nothing.
+	/// </summary>
+	/// <param name="enabled">Use the sparse mode ? (enable the compute mode)</param>
+	/// <returns>If the sparse mode is enabled (it needs the compute mode)</returns>
+	bool SetSparseMode(bool enabled) {
+		if (enabled && !this->computeMode && !SetComputeMode(true)) {
+			return false;
+		}
+		if (enabled && this->tileShader == nullptr) {
+			this->tileShader = Shader::Compute("Physics/tiles.comp");
+			GenerateTiles();
+		}
+		if (enabled && !this->sparseMode) {
+			//Every tile is computed once, to measure the current water.
+			std::fill(this->forcedTiles.begin(), this->forcedTiles.end(), 1);
+			this->forcedChanged = true;
+		}
+		this->sparseMode = enabled;
+		if (this->computeShader != nullptr) {
+			this->computeShader->DefineOverride(Shader::DataOverride(Shader::COMPUTE, "SPARSE", enabled ? "1" : "0"));
+		}
+		return this->sparseMode;
+	}
+
+	/// <summary>
+	/// Synthesize the water from a wave spectrum instead of the ripples: a periodic patch of waves by inverse FFT, tiled over the water.
+	/// The cost per frame depend on the patch only, so a big tank get rich waves without a higher resolution nor more steps.
+	/// The drops and the footprints of the colliders are not simulated in the ocean mode.
+	/// </summary>
+	/// <param name="enabled">Use the ocean mode ? (the water is reset flat when disabled)</param>
+	/// <param name="settings">The spectrum, the size of the patch, the wind</param>
+	/// <param name="size">The resolution of the patch, rounded up to a power of two (at most 1024 on the GPU)</param>
+	/// <param name="gpu">Synthesize with the compute shaders (it needs OpenGL 4.3), else with the SIMD multithreaded CPU FFT</param>
+	void SetOceanMode(bool enabled, OceanSolver::Settings settings = OceanSolver::Settings(), int size = 128, bool gpu = true) {
+		delete this->ocean;
+		this->ocean = nullptr;
+		if (!enabled) {
+			GenerateState();
+			return;
+		}
+		this->ocean = new OceanSolver(size, settings);
+		this->oceanGPU = gpu && GLEW_VERSION_4_3 && this->ocean->GetSize() <= 1024;
+		this->dropHead = this->dropCount = 0;
+		GenerateOcean();
+	}
+
+	/// <summary>
+	/// Return the solver of the ocean mode, e.g. to change its settings.
+	/// </summary>
+	/// <returns>The solver, nullptr without the ocean mode</returns>
+	OceanSolver* GetOcean() {
+		return this->ocean;
+	}
+
+	/// <summary>
+	/// Set the height or velocity under which a tile is calm, in sparse mode.
+	/// </summary>
+	/// <param name="threshold">The threshold</param>
+	void SetActivityThreshold(float threshold) {
+		this->activityThreshold = threshold;
+	}
+
+	/// <summary>
+	/// Set the number of water steps per frame in compute mode, done in one dispatch. The damping of each step use its part of the frame time.
+	/// </summary>
+	/// <param name="substeps">The number of steps (at least 1), each one widen the halo loaded by a tile</param>
+	void SetSubsteps(int substeps) {
+		this->substeps = std::max(substeps, 1);
+		if (this->computeShader != nullptr) {
+			this->computeShader->DefineOverride(Shader::DataOverride(Shader::COMPUTE, "SUBSTEPS", std::to_string(this->substeps)));
+		}
+	}
+
+	/// <summary>
+	/// Set the resolution of the caustics.
+	/// </summary>
+	/// <param name="quality">The resolution tier</param>
+	void SetCausticsQuality(CausticsQuality quality) {
+		this->causticsQuality = quality;
+		if (this->causticFramebuffers[0].GetWidth() > 0) {
+			GenerateCaustics();
+		}
+	}
+
+	/// <summary>
+	/// Set the cadence of the caustics: updated every few frames, and blended from the previous result to the latest in between.
+	/// </summary>
+	/// <param name="frames">The number of frames between two updates (1 = every frame)</param>
+	/// <param name="onDrop">Update as soon as a drop fell on the water ?</param>
+	void SetCausticsInterval(int frames, bool onDrop = true) {
+		this->causticsInterval = std::max(frames, 1);
+		this->causticsOnDrop = onDrop;
+	}
+
+	/// <summary>
+	/// Read the water state back each frame for SampleHeight and SampleNormal, through pixel buffers mapped a frame or two later, without stall.
+	/// Off by default, turned on by the first SampleHeight or SampleNormal unless set here.
+	/// </summary>
+	/// <param name="enabled">Read the state back ?</param>
+	/// <param name="level">The mipmap level read, each level halve the resolution (0 = full resolution)</param>
+	void SetHeightQueries(bool enabled, int level = 2) {
+		this->heightQueries = enabled;
+		this->heightQueriesSet = true;
+		this->heightLevel = std::max(level, 0);
+	}
+
+	/// <summary>
+	/// Return if a state was read back, for SampleHeight and SampleNormal.
+	/// </summary>
+	/// <returns>If the queries have data</returns>
+	bool HasHeights() {
+		return !this->heights.empty();
+	}
+
+	/// <summary>
+	/// Return the height of the water surface at rest, the top of its bounding box.
+	/// </summary>
+	/// <returns>The height, in world space</returns>
+	float GetRestLevel() {
+		if (this->attachment == nullptr) {
+			return 0.0f;
+		}
+		BoundingBoxCollider* bb = this->attachment->getFirstComponentByType<BoundingBoxCollider>();
+		return bb != nullptr ? bb->GetMax().y : this->attachment->GetPositionWithRecursiveMatrix().y;
+	}
+
+	/// <summary>
+	/// Return the height of the water surface, from the latest state read back (a frame or two late), never waiting the GPU.
+	/// The first query turn the read back on (see SetHeightQueries).
+	/// </summary>
+	/// <param name="x">The x position, in world space</param>
+	/// <param name="z">The z position, in world space</param>
+	/// <returns>The height of the surface, in world space (the rest level if no state was read back yet)</returns>
+	float SampleHeight(float x, float z) {
+		return GetRestLevel() + SampleState(x, z).r;
+	}
+
+	/// <summary>
+	/// Return the normal of the water surface, from the latest state read back (a frame or two late), never waiting the GPU.
+	/// The first query turn the read back on (see SetHeightQueries).
+	/// </summary>
+	/// <param name="x">The x position, in world space</param>
+	/// <param name="z">The z position, in world space</param>
+	/// <returns>The normal of the surface, in world space (up if no state was read back yet)</returns>
+	glm::vec3 SampleNormal(float x, float z) {
+		glm::vec4 d = SampleState(x, z);
+		if (!HasHeights()) {
+			return glm::vec3(0, 1, 0);
+		}
+		if (this->derivedNormals) {
+			//Derived from the heights as the shaders, over a texel of the state read back in world units.
+			glm::vec2 texel = this->containerSize / glm::vec2(this->heightW, this->heightH);
+			float dx = SampleState(x + texel.x, z).r - d.r;
+			float dz = SampleState(x, z + texel.y).r - d.r;
+			return glm::normalize(glm::vec3(-dx / texel.x, 1.0f, -dz / texel.y));
+		}
+		//The stored normal is in texture space: its slope is per unit of texture, per container size in world space.
+		float y = sqrtf(std::max(0.0f, 1.0f - d.b * d.b - d.a * d.a));
+		if (y < 1e-6f) {
+			return glm::normalize(glm::vec3(d.b, 0.0f, d.a));
+		}
+		return glm::normalize(glm::vec3(d.b / (y * this->containerSize.x), 1.0f, d.a / (y * this->containerSize.y)));
 	}
 
 	/// <summary>
@@ -107,9 +418,26 @@ public:
 			frameForCaptureCurrent = frameForCapture;
 		}
 
-		DropCompute();
-		WaterCompute(delta);
-		CausticsCompute(glm::normalize(glm::vec3(0, -1, 0)));
+		this->capture.Update();
+		this->heightReadback.Update();
+
+		bool dropped = this->dropCount > 0;
+		if (this->ocean != nullptr) {
+			this->dropHead = this->dropCount = 0;
+			OceanCompute(delta);
+		}
+		else {
+			FootprintCompute();
+			DropCompute();
+			WaterCompute(delta);
+		}
+		HeightRequest();
+
+		this->causticsAge++;
+		if (this->causticsAge >= this->causticsInterval || (dropped && this->causticsOnDrop) || !this->causticsPrimed) {
+			CausticsCompute(glm::normalize(glm::vec3(0, -1, 0)));
+			this->causticsAge = 0;
+		}
 
 		if (frameForCaptureCurrent <= frameForCapture) {
 			frameForCaptureCurrent--;
@@ -125,7 +453,7 @@ public:
 	/// </summary>
 	/// <returns>The heightmap</returns>
 	GLuint GetHeightmap() {
-		return this->framebuffer.GetTexColor();
+		return this->state.GetRead();
 	}
 
 
@@ -142,56 +470,453 @@ public:
 	/// </summary>
 	/// <returns>The caustics color texture</returns>
 	GLuint GetCaustics() {
-		return this->causticFramebuffer.GetTexColor();
+		return this->causticFramebuffers[this->causticLatest].GetTexColor();
+	}
+
+	/// <summary>
+	/// Return the caustics color texture of the update before the latest one
+	/// </summary>
+	/// <returns>The previous caustics color texture</returns>
+	GLuint GetCausticsPrevious() {
+		return this->causticFramebuffers[1 - this->causticLatest].GetTexColor();
+	}
+
+	/// <summary>
+	/// Return the blend from the previous caustics to the latest ones, reaching 1 when the next update is due.
+	/// </summary>
+	/// <returns>The blend factor</returns>
+	float GetCausticsBlend() {
+		return std::min(1.0f, (float)(this->causticsAge + 1) / (float)this->causticsInterval);
 	}
 private:
 	/// <summary>
-	/// Compute the Drop water shader.
+	/// Sample the latest state read back, bilinear.
 	/// </summary>
-	void DropCompute() {
-		if (drops.size() > 0) {
-			//Bind framebuffer
-			glViewport(0, 0, this->framebuffer.GetWidth(), this->framebuffer.GetHeight());
-			glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer.GetFramebuffer());
+	/// <param name="x">The x position, in world space</param>
+	/// <param name="z">The z position, in world space</param>
+	/// <returns>The state (height, velocity, normal x, normal z, no normal in compact state), 0 if no state was read back yet</returns>
+	glm::vec4 SampleState(float x, float z) {
+		if (!this->heightQueriesSet) {
+			this->heightQueries = true;
+		}
+		if (this->heights.empty() || this->attachment == nullptr) {
+			return glm::vec4(0);
+		}
+		glm::vec3 center = this->attachment->GetPositionWithRecursiveMatrix();
+		glm::vec2 uv = (glm::vec2(x - center.x, z - center.z) + this->containerSize / 2.0f) / this->containerSize;
 
-			glEnable(GL_DEPTH_TEST);
-			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-			glClearColor(0, 0, 0, 1);
+		float fx = glm::clamp(uv.x * this->heightW - 0.5f, 0.0f, (float)(this->heightW - 1));
+		float fy = glm::clamp(uv.y * this->heightH - 0.5f, 0.0f, (float)(this->heightH - 1));
+		int x0 = (int)fx, y0 = (int)fy;
+		int x1 = std::min(x0 + 1, this->heightW - 1), y1 = std::min(y0 + 1, this->heightH - 1);
+		float tx = fx - x0, ty = fy - y0;
+
+		const glm::vec4* texels = (const glm::vec4*)this->heights.data();
+		glm::vec4 a = glm::mix(texels[y0 * this->heightW + x0], texels[y0 * this->heightW + x1], tx);
+		glm::vec4 b = glm::mix(texels[y1 * this->heightW + x0], texels[y1 * this->heightW + x1], tx);
+		return glm::mix(a, b, ty);
+	}
 
-			glUseProgram(dropShader->GetProgram());
-			//Set Data
-			glUniform1i(glGetUniformLocation(dropShader->GetProgram(), "tex"), 0);
+	/// <summary>
+	/// Start the read back of the current state, downsampled by its mipmaps, for the CPU queries.
+	/// </summary>
+	void HeightRequest() {
+		if (!this->heightQueries) {
+			return;
+		}
+		int level = this->heightLevel;
+		while (level > 0 && ((this->resolutionX >> level) < 1 || (this->resolutionY >> level) < 1)) {
+			level--;
+		}
+		int w = this->resolutionX >> level;
+		int h = this->resolutionY >> level;
 
-			// Set Drop
+		if (level > 0) {
+			glBindTexture(GL_TEXTURE_2D, this->state.GetRead());
+			glGenerateMipmap(GL_TEXTURE_2D);
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+		this->heightReadback.Read(this->state.GetRead(), level, w, h, true, [this, w, h](std::vector<unsigned char>& data) {
+			this->heights.resize(data.size() / sizeof(float));
+			memcpy(this->heights.data(), data.data(), data.size());
+			this->heightW = w;
+			this->heightH = h;
+		});
+	}
 
-			glUniform2f(glGetUniformLocation(dropShader->GetProgram(), "center"), drops[0].pos.x, drops[0].pos.y);
-			glUniform1f(glGetUniformLocation(dropShader->GetProgram(), "radius"), drops[0].radius);
-			glUniform1f(glGetUniformLocation(dropShader->GetProgram(), "strength"), drops[0].strength);
+	/// <summary>
+	/// Generate the state textures, flat water, in the format of the state.
+	/// </summary>
+	void GenerateState() {
+		std::vector<float> data((size_t)this->resolutionX * (size_t)this->resolutionY * 4);
+		for (size_t i = 0, max = data.size(); i < max; i++) {
+			data[i] = (i % 4 == 3 ? 1.0f : 0.0f);
+		}
 
-			//Bind Texture
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, this->texture);
+		this->state.Generate(this->resolutionX, this->resolutionY, data.data(), this->derivedNormals ? GL_RG16F : GL_RGBA16F);
+		this->texture = this->state.GetRead();
+	}
 
-			//Draw Mesh
-			glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-			//glVertexPointer(3, GL_FLOAT, 0, &quad[0]);
-			//glDrawArrays(GL_TRIANGLES, 0, quad.size());
+	/// <summary>
+	/// Generate the two caustics framebuffers, at the resolution of the quality tier. The intensity only, without depth.
+	/// </summary>
+	void GenerateCaustics() {
+		const float scales[4] = { 0.5f, 1.0f, 2.0f, 4.0f };
+		float scale = scales[this->causticsQuality];
+		int w = std::max(1, (int)(this->resolutionX * scale));
+		int h = std::max(1, (int)(this->resolutionY * scale));
+		for (Framebuffer& fb : this->causticFramebuffers) {
+			fb.Generate(w, h, RenderTargetDesc::Color(GL_R8));
+		}
+		this->causticsPrimed = false;
+	}
 
-			Model::Data mData = this->quad->GetData();
-			glBindVertexArray(mData.VAO);
-			glDrawElements(GL_TRIANGLES, mData.sizeEBO, GL_UNSIGNED_INT, 0);
+	/// <summary>
+	/// Generate the textures of the ocean mode: the patch, and for the GPU path the initial spectrum of the solver and the FFT intermediate.
+	/// </summary>
+	void GenerateOcean() {
+		int n = this->ocean->GetSize();
+		glDeleteTextures(1, &this->oceanInitial);
+		glDeleteTextures(1, &this->oceanPatch);
+		glDeleteTextures(1, &this->oceanScratch);
+		this->oceanInitial = this->oceanScratch = 0;
 
-			glFlush();
+		//The patch is repeated over the water.
+		glGenTextures(1, &this->oceanPatch);
+		glBindTexture(GL_TEXTURE_2D, this->oceanPatch);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, n, n, 0, GL_RGBA, GL_FLOAT, NULL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-			glBindTexture(GL_TEXTURE_2D, this->texture);
-			glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, this->resolutionX, this->resolutionY);
+		if (this->oceanShader == nullptr) {
+			this->oceanShader = new Shader("Physics/water.vert", "Physics/ocean.frag");
+		}
 
-			//Release
-			glBindFramebuffer(GL_FRAMEBUFFER, 0);
-			glViewport(0, 0, global.screen_width, global.screen_height);
+		if (this->oceanGPU) {
+			for (GLuint* texture : { &this->oceanInitial, &this->oceanScratch }) {
+				glGenTextures(1, texture);
+				glBindTexture(GL_TEXTURE_2D, *texture);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, n, n, 0, GL_RGBA, GL_FLOAT, NULL);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			}
+			glBindTexture(GL_TEXTURE_2D, this->oceanInitial);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, n, n, GL_RGBA, GL_FLOAT, this->ocean->GetSpectrum().data());
 
-			drops.erase(drops.begin());
+			if (this->oceanSpectrumShader == nullptr) {
+				this->oceanSpectrumShader = Shader::Compute("Physics/ocean_spectrum.comp");
+				this->oceanFFTShader = Shader::Compute("Physics/ocean_fft.comp");
+			}
+			int logSize = 0;
+			while ((1 << logSize) < n) {
+				logSize++;
+			}
+			std::vector<Shader::DataOverride> defines;
+			defines.push_back(Shader::DataOverride(Shader::COMPUTE, "SIZE", std::to_string(n)));
+			defines.push_back(Shader::DataOverride(Shader::COMPUTE, "LOG_SIZE", std::to_string(logSize)));
+			defines.push_back(Shader::DataOverride(Shader::COMPUTE, "THREADS", std::to_string(n / 2)));
+			this->oceanFFTShader->DefineOverride(defines);
 		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	/// <summary>
+	/// Generate the buffers of the sparse mode, every tile calm.
+	/// </summary>
+	void GenerateTiles() {
+		this->tileCountX = (this->resolutionX + ACTIVE_TILE - 1) / ACTIVE_TILE;
+		this->tileCountY = (this->resolutionY + ACTIVE_TILE - 1) / ACTIVE_TILE;
+		size_t count = (size_t)this->tileCountX * (size_t)this->tileCountY;
+		this->forcedTiles.assign(count, 0);
+
+		std::vector<GLuint> zeros(count, 0);
+		for (GLuint* buffer : { &this->tileList, &this->tileEnergy, &this->tileForced, &this->tileSettle }) {
+			glGenBuffers(1, buffer);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, *buffer);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, count * sizeof(GLuint), zeros.data(), GL_DYNAMIC_DRAW);
+		}
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		const GLuint groups[3] = { 0, 1, 1 };
+		glGenBuffers(1, &this->tileDispatch);
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, this->tileDispatch);
+		glBufferData(GL_DISPATCH_INDIRECT_BUFFER, sizeof(groups), groups, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+	}
+
+	/// <summary>
+	/// Mark the tiles under a drop, computed on the next step even if they are calm.
+	/// </summary>
+	/// <param name="pos">The position of the drop on the texture</param>
+	/// <param name="radius">The radius of the drop</param>
+	void ForceTiles(glm::vec2 pos, float radius) {
+		if (this->forcedTiles.empty()) {
+			return;
+		}
+		int x0 = std::max(0, (int)floorf((pos.x - radius) * this->resolutionX) / ACTIVE_TILE);
+		int x1 = std::min(this->tileCountX - 1, (int)ceilf((pos.x + radius) * this->resolutionX) / ACTIVE_TILE);
+		int y0 = std::max(0, (int)floorf((pos.y - radius) * this->resolutionY) / ACTIVE_TILE);
+		int y1 = std::min(this->tileCountY - 1, (int)ceilf((pos.y + radius) * this->resolutionY) / ACTIVE_TILE);
+		for (int y = y0; y <= y1; y++) {
+			for (int x = x0; x <= x1; x++) {
+				this->forcedTiles[(size_t)y * this->tileCountX + x] = 1;
+				this->forcedChanged = true;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Choose the tiles computed by the next step, and write their number of work groups in the indirect dispatch buffer.
+	/// </summary>
+	void TileCompute() {
+		size_t count = this->forcedTiles.size();
+		if (this->forcedChanged) {
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->tileForced);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(GLuint), this->forcedTiles.data());
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+			std::fill(this->forcedTiles.begin(), this->forcedTiles.end(), 0);
+			this->forcedChanged = false;
+		}
+		const GLuint groups[3] = { 0, 1, 1 };
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, this->tileDispatch);
+		glBufferSubData(GL_DISPATCH_INDIRECT_BUFFER, 0, sizeof(groups), groups);
+		glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, this->tileList);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, this->tileEnergy);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, this->tileForced);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, this->tileSettle);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, this->tileDispatch);
+
+		GLuint program = this->tileShader->GetProgram();
+		glUseProgram(program);
+		glUniform2i(glGetUniformLocation(program, "tileCount"), this->tileCountX, this->tileCountY);
+		glUniform1f(glGetUniformLocation(program, "threshold"), this->activityThreshold);
+		glDispatchCompute((GLuint)((count + 63) / 64), 1, 1);
+
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+		//The step measure the energy again, and the drops are consumed.
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->tileEnergy);
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->tileForced);
+		glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	/// <summary>
+	/// Generate the buffers of the drop and footprint passes, a unit quad instanced once per drop or footprint.
+	/// </summary>
+	void GenerateSplat() {
+		const float corners[8] = { -1, -1, 1, -1, -1, 1, 1, 1 };
+
+		glGenVertexArrays(1, &this->splatVAO);
+		glGenBuffers(2, this->splatVBO);
+		glBindVertexArray(this->splatVAO);
+
+		glEnableVertexAttribArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, this->splatVBO[0]);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+
+		glEnableVertexAttribArray(1);
+		glBindBuffer(GL_ARRAY_BUFFER, this->splatVBO[1]);
+		glBufferData(GL_ARRAY_BUFFER, this->drops.size() * sizeof(Drop), NULL, GL_STREAM_DRAW);
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Drop), (void*)0);
+		glVertexAttribDivisor(1, 1);
+
+		//The footprints, on the same corners.
+		glGenVertexArrays(1, &this->footprintVAO);
+		glGenBuffers(1, &this->footprintVBO);
+		glBindVertexArray(this->footprintVAO);
+
+		glEnableVertexAttribArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, this->splatVBO[0]);
+		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+
+		glBindBuffer(GL_ARRAY_BUFFER, this->footprintVBO);
+		for (GLuint i = 0; i < 3; i++) {
+			glEnableVertexAttribArray(1 + i);
+			glVertexAttribPointer(1 + i, 4, GL_FLOAT, GL_FALSE, sizeof(Footprint), (void*)(i * sizeof(glm::vec4)));
+			glVertexAttribDivisor(1 + i, 1);
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindVertexArray(0);
+	}
+
+	/// <summary>
+	/// Return the shape of a collider, relative to the water center at rest. A box or a convex hull is its world bounding box.
+	/// </summary>
+	/// <param name="collider">The collider</param>
+	/// <param name="center">The water center at rest</param>
+	/// <returns>The shape</returns>
+	Shape ColliderShape(ICollider* collider, glm::vec3 center) {
+		//Up to date with the transform, not recomputed if it did not change.
+		collider->UpdateWorldCache();
+		Shape shape;
+		if (collider->ColliderType() == ICollider::Sphere) {
+			const SphereCollider::WorldCache& w = ((SphereCollider*)collider)->GetWorld();
+			shape.center = w.center - center;
+			shape.extent = glm::vec3(w.radius);
+			shape.sphere = true;
+		}
+		else {
+			glm::vec3 min, max;
+			collider->GetWorldBounds(min, max);
+			shape.center = (min + max) * 0.5f - center;
+			shape.extent = (max - min) * 0.5f;
+			shape.sphere = false;
+		}
+		return shape;
+	}
+
+	/// <summary>
+	/// Rasterize the footprints of the colliders that moved across the surface in one instanced draw, in the displacement consumed by the next step.
+	/// A footprint is the submerged thickness of the collider at its previous position minus at its current one, so a moving collider leave a wake.
+	/// The still colliders have no footprint, the GPU cost does not depend on the number of colliders.
+	/// </summary>
+	void FootprintCompute() {
+		this->footprints.clear();
+		if (this->attachment == nullptr || this->couplingStrength <= 0.0f) {
+			this->colliderShapes.clear();
+			return;
+		}
+		glm::vec3 center = this->attachment->GetPositionWithRecursiveMatrix();
+		center.y = GetRestLevel();
+
+		std::unordered_map<ICollider*, Shape> shapes;
+		std::vector<ICollider*> colliders = this->attachment->GetParentRecursive()->getComponentsByTypeRecursive<ICollider>(true);
+		for (ICollider* c : colliders) {
+			//The triggers (e.g. the culling box of a Model) do not push the water.
+			if (c->attachment == this->attachment || c->IsTrigger()) {
+				continue;
+			}
+			Shape shape = ColliderShape(c, center);
+			shapes[c] = shape;
+
+			//A new collider has no previous shape, a still one no footprint.
+			std::unordered_map<ICollider*, Shape>::iterator last = this->colliderShapes.find(c);
+			if (last == this->colliderShapes.end()) {
+				continue;
+			}
+			const Shape& previous = last->second;
+			if (previous.center == shape.center && previous.extent == shape.extent) {
+				continue;
+			}
+			//Only the colliders crossing the surface, now or at the last frame.
+			bool crossing = fabsf(shape.center.y) <= shape.extent.y || fabsf(previous.center.y) <= previous.extent.y;
+			if (!crossing) {
+				continue;
+			}
+
+			Footprint f;
+			f.current = glm::vec4(shape.center, shape.sphere ? 0.0f : 1.0f);
+			f.previous = glm::vec4(previous.center, this->couplingStrength);
+			f.extent = glm::vec4(shape.extent, 0.0f);
+			this->footprints.push_back(f);
+
+			glm::vec2 low = glm::min(glm::vec2(shape.center.x, shape.center.z), glm::vec2(previous.center.x, previous.center.z)) - glm::vec2(shape.extent.x, shape.extent.z);
+			glm::vec2 high = glm::max(glm::vec2(shape.center.x, shape.center.z), glm::vec2(previous.center.x, previous.center.z)) + glm::vec2(shape.extent.x, shape.extent.z);
+			glm::vec2 radius = (high - low) * 0.5f / this->containerSize;
+			ForceTiles((low + high) * 0.5f / this->containerSize + 0.5f, std::max(radius.x, radius.y));
+		}
+		this->colliderShapes.swap(shapes);
+
+		if (this->footprints.empty()) {
+			return;
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, this->footprintVBO);
+		glBufferData(GL_ARRAY_BUFFER, this->footprints.size() * sizeof(Footprint), this->footprints.data(), GL_STREAM_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		glViewport(0, 0, this->displacement.GetWidth(), this->displacement.GetHeight());
+		glBindFramebuffer(GL_FRAMEBUFFER, this->displacement.GetFramebuffer());
+		glClearColor(0, 0, 0, 0);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+
+		GLuint program = this->footprintShader->GetProgram();
+		glUseProgram(program);
+		glUniform2f(glGetUniformLocation(program, "containerSize"), this->containerSize.x, this->containerSize.y);
+		glUniform2f(glGetUniformLocation(program, "texel"), this->containerSize.x * this->invResX, this->containerSize.y * this->invResY);
+
+		glBindVertexArray(this->footprintVAO);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)this->footprints.size());
+		glBindVertexArray(0);
+
+		glDisable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		//Release
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, global.screen_width, global.screen_height);
+
+		this->displaced = true;
+	}
+
+	/// <summary>
+	/// Bind the displacement to the texture unit 1 of a step program, if it holds footprints to consume.
+	/// </summary>
+	/// <param name="program">The program of the step</param>
+	void BindDisplacement(GLuint program) {
+		glUniform1i(glGetUniformLocation(program, "displacement"), 1);
+		glUniform1i(glGetUniformLocation(program, "useDisplacement"), this->displaced ? 1 : 0);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, this->displaced ? this->displacement.GetTexColor() : 0);
+		glActiveTexture(GL_TEXTURE0);
+		this->displaced = false;
+	}
+
+	/// <summary>
+	/// Apply all the queued drops in one instanced draw, each drop covering only its radius and added to the height.
+	/// </summary>
+	void DropCompute() {
+		if (this->dropCount == 0) {
+			return;
+		}
+
+		//Upload the ring buffer, in one or two parts.
+		size_t capacity = this->drops.size();
+		size_t first = std::min(this->dropCount, capacity - this->dropHead);
+		glBindBuffer(GL_ARRAY_BUFFER, this->splatVBO[1]);
+		glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Drop), NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, first * sizeof(Drop), &this->drops[this->dropHead]);
+		if (first < this->dropCount) {
+			glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(Drop), (this->dropCount - first) * sizeof(Drop), &this->drops[0]);
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		//Blend on the current state, in place.
+		this->state.BindRead();
+
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+
+		glUseProgram(dropShader->GetProgram());
+
+		glBindVertexArray(this->splatVAO);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)this->dropCount);
+		glBindVertexArray(0);
+
+		glFlush();
+
+		glDisable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+		//Release
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, global.screen_width, global.screen_height);
+
+		this->dropHead = (this->dropHead + this->dropCount) % capacity;
+		this->dropCount = 0;
 	}
 
 
@@ -199,19 +924,22 @@ private:
 	/// Compute the water animation shader.
 	/// </summary>
 	void WaterCompute(double delta) {
-		//Bind framebuffer
-		glViewport(0, 0, this->framebuffer.GetWidth(), this->framebuffer.GetHeight());
-		glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer.GetFramebuffer());
+		if (this->computeMode) {
+			WaterDispatch(delta);
+			return;
+		}
+
+		//Bind framebuffer, every texel is written, no clear.
+		this->state.BindWrite();
 
-		glEnable(GL_DEPTH_TEST);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		glClearColor(0, 0, 0, 1);
+		glDisable(GL_DEPTH_TEST);
 
 		glUseProgram(physicShader->GetProgram());
 		//Set Data
 		glUniform1f(glGetUniformLocation(physicShader->GetProgram(), "deltaTime"), delta);
 		glUniform2f(glGetUniformLocation(physicShader->GetProgram(), "deltaMove"), invResX, invResY);
 		glUniform1i(glGetUniformLocation(physicShader->GetProgram(), "tex"), 0);
+		BindDisplacement(physicShader->GetProgram());
 
 		//Bind Texture
 		glActiveTexture(GL_TEXTURE0);
@@ -228,30 +956,148 @@ private:
 
 		glFlush();
 
+		//The result is the new state.
+		this->state.Swap();
+		this->texture = this->state.GetRead();
+
 		if (frameForCaptureCurrent <= frameForCapture && frameForCaptureCurrent > 0) {
 			std::string name = "capture/" + std::to_string(frameForCapture - frameForCaptureCurrent) + ".1.png";
-			this->framebuffer.WriteTextureToFile(name);
+			this->capture.Request(this->state.GetRead(), this->resolutionX, this->resolutionY, true, name);
 		}
 
-		glBindTexture(GL_TEXTURE_2D, this->texture);
-		glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, this->resolutionX, this->resolutionY);
+		//Release
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, global.screen_width, global.screen_height);
+	}
+
+	/// <summary>
+	/// Synthesize the ocean patch at the time of the frame, on the GPU or the CPU, then tile it over the water as the new state.
+	/// </summary>
+	/// <param name="delta">Time since last frame</param>
+	void OceanCompute(double delta) {
+		this->oceanTime += delta;
+		int n = this->ocean->GetSize();
+		if (this->oceanGPU) {
+			OceanDispatch((float)this->oceanTime);
+		}
+		else {
+			this->ocean->Synthesize((float)this->oceanTime);
+			this->ocean->GetPatch(this->oceanUpload);
+			glBindTexture(GL_TEXTURE_2D, this->oceanPatch);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, n, n, GL_RGBA, GL_FLOAT, this->oceanUpload.data());
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+
+		//Every texel is written, no clear.
+		this->state.BindWrite();
+		glDisable(GL_DEPTH_TEST);
+
+		GLuint program = this->oceanShader->GetProgram();
+		glUseProgram(program);
+		glm::vec2 tiling = this->containerSize / this->ocean->GetSettings().patchSize;
+		glUniform1i(glGetUniformLocation(program, "waves"), 0);
+		glUniform2f(glGetUniformLocation(program, "tiling"), tiling.x, tiling.y);
+		glUniform2f(glGetUniformLocation(program, "slopeScale"), this->containerSize.x, this->containerSize.y);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, this->oceanPatch);
+
+		Model::Data mData = this->quad->GetData();
+		glBindVertexArray(mData.VAO);
+		glDrawElements(GL_TRIANGLES, mData.sizeEBO, GL_UNSIGNED_INT, 0);
+		glBindVertexArray(0);
+
+		//The result is the new state.
+		this->state.Swap();
+		this->texture = this->state.GetRead();
 
 		//Release
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 		glViewport(0, 0, global.screen_width, global.screen_height);
 	}
 
+	/// <summary>
+	/// Synthesize the ocean patch with the compute shaders: the spectrum at the time, then the FFT of the rows and of the columns, each line in one work group.
+	/// </summary>
+	/// <param name="time">The time of the waves</param>
+	void OceanDispatch(float time) {
+		int n = this->ocean->GetSize();
+
+		GLuint program = this->oceanSpectrumShader->GetProgram();
+		glUseProgram(program);
+		glUniform1f(glGetUniformLocation(program, "time"), time);
+		glUniform1f(glGetUniformLocation(program, "patchSize"), this->ocean->GetSettings().patchSize);
+		glBindImageTexture(0, this->oceanInitial, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+		glBindImageTexture(1, this->oceanPatch, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+		glDispatchCompute((n + 15) / 16, (n + 15) / 16, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+		program = this->oceanFFTShader->GetProgram();
+		glUseProgram(program);
+		const GLuint passes[2][2] = { { this->oceanPatch, this->oceanScratch }, { this->oceanScratch, this->oceanPatch } };
+		for (int vertical = 0; vertical < 2; vertical++) {
+			glUniform1i(glGetUniformLocation(program, "vertical"), vertical);
+			glBindImageTexture(0, passes[vertical][0], 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
+			glBindImageTexture(1, passes[vertical][1], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
+			glDispatchCompute(n, 1, 1);
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+		}
+	}
+
+	/// <summary>
+	/// Compute the water animation with the compute shader, all the substeps in one dispatch.
+	/// </summary>
+	void WaterDispatch(double delta) {
+		if (this->sparseMode) {
+			TileCompute();
+		}
+
+		GLuint program = this->computeShader->GetProgram();
+		glUseProgram(program);
+		glUniform1f(glGetUniformLocation(program, "deltaTime"), (float)(delta / this->substeps));
+		glUniform2f(glGetUniformLocation(program, "deltaMove"), invResX, invResY);
+		BindDisplacement(program);
+
+		GLenum format = this->derivedNormals ? GL_RG16F : GL_RGBA16F;
+		glBindImageTexture(0, this->state.GetRead(), 0, GL_FALSE, 0, GL_READ_ONLY, format);
+		glBindImageTexture(1, this->state.GetWrite(), 0, GL_FALSE, 0, GL_WRITE_ONLY, format);
+
+		if (this->sparseMode) {
+			//The skipped tiles are flat in both textures, the write texture is already right there.
+			glUniform1i(glGetUniformLocation(program, "tileCountX"), this->tileCountX);
+			glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, this->tileDispatch);
+			glDispatchComputeIndirect(0);
+			glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+		}
+		else {
+			glDispatchCompute((this->resolutionX + COMPUTE_TILE - 1) / COMPUTE_TILE, (this->resolutionY + COMPUTE_TILE - 1) / COMPUTE_TILE, 1);
+		}
+
+		//The next passes sample or render the result, and the next tile pass read the energy.
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+		//The result is the new state.
+		this->state.Swap();
+		this->texture = this->state.GetRead();
+
+		if (frameForCaptureCurrent <= frameForCapture && frameForCaptureCurrent > 0) {
+			std::string name = "capture/" + std::to_string(frameForCapture - frameForCaptureCurrent) + ".1.png";
+			this->capture.Request(this->state.GetRead(), this->resolutionX, this->resolutionY, true, name);
+		}
+	}
+
 	/// <summary>
 	/// Compute the caustics.
 	/// </summary>
 	/// <param name="lightDir">The light direction.</param>
 	void CausticsCompute(glm::vec3 lightDir) {
-		glViewport(0, 0, this->causticFramebuffer.GetWidth(), this->causticFramebuffer.GetHeight());
-		glBindFramebuffer(GL_FRAMEBUFFER, this->causticFramebuffer.GetFramebuffer());
+		//Render over the oldest caustics, the latest become the previous ones.
+		this->causticLatest = 1 - this->causticLatest;
+		Framebuffer& causticFramebuffer = this->causticFramebuffers[this->causticLatest];
+		glViewport(0, 0, causticFramebuffer.GetWidth(), causticFramebuffer.GetHeight());
+		//Every texel is written, no clear.
+		glBindFramebuffer(GL_FRAMEBUFFER, causticFramebuffer.GetFramebuffer());
 
-		glEnable(GL_DEPTH_TEST);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		glClearColor(0, 0, 0, 0);
+		glDisable(GL_DEPTH_TEST);
 
 		glUseProgram(this->causticShader->GetProgram());
 
@@ -260,6 +1106,7 @@ private:
 
 		// Set Data
 		glUniform3f(glGetUniformLocation(causticShader->GetProgram(), "lightDirection"), lightDir.x, lightDir.y, lightDir.z);
+		glUniform1i(glGetUniformLocation(causticShader->GetProgram(), "u_physics_derived_normals"), this->derivedNormals ? 1 : 0);
 
 		//Bind Texture
 		glActiveTexture(GL_TEXTURE0);
@@ -274,11 +1121,19 @@ private:
 
 		if (frameForCaptureCurrent <= frameForCapture && frameForCaptureCurrent > 0) {
 			std::string name = "capture/" + std::to_string(frameForCapture - frameForCaptureCurrent) + ".2.png";
-			this->causticFramebuffer.WriteTextureToFile(name);
+			this->capture.Request(causticFramebuffer.GetTexColor(), causticFramebuffer.GetWidth(), causticFramebuffer.GetHeight(), false, name);
 		}
 
 		glFlush();
 
+		//The first caustics are also the previous ones.
+		if (!this->causticsPrimed) {
+			this->causticsPrimed = true;
+			glBindFramebuffer(GL_READ_FRAMEBUFFER, causticFramebuffer.GetFramebuffer());
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, this->causticFramebuffers[1 - this->causticLatest].GetFramebuffer());
+			glBlitFramebuffer(0, 0, causticFramebuffer.GetWidth(), causticFramebuffer.GetHeight(), 0, 0, causticFramebuffer.GetWidth(), causticFramebuffer.GetHeight(), GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		}
+
 
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 		glViewport(0, 0, global.screen_width, global.screen_height);
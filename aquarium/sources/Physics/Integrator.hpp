@@ -0,0 +1,225 @@
+#ifndef __INTEGRATOR_HPP__
+#define __INTEGRATOR_HPP__
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include <Engine/Tools/Simd.hpp>
+#include <Engine/Tools/JobPool.hpp>
+#include <Physics/Physics/Rigidbody.hpp>
+
+/// <summary>
+/// Integrate the rigidbodies of a scene in world space.
+/// The awake bodies are gathered in SoA arrays (position, velocity, angular velocity, acceleration, force, inverse mass, drag), integrated 8 by 8 with AVX or 4 by 4 with SSE2 in chunks across the JobPool,
+/// then the displacement is written back once to each transformation.
+/// The displacement of the bodies with continuous collision detection is swept first, and stopped at the first impact.
+/// </summary>
+class Integrator {
+protected:
+	glm::vec3 gravity = Rigidbody::DefaultGravity();
+
+	//Number of bodies of a chunk given to a thread.
+	size_t chunkSize = 256;
+
+	std::vector<Rigidbody*> bodies;
+	std::vector<float> px, py, pz;
+	std::vector<float> vx, vy, vz;
+	std::vector<float> wx, wy, wz;
+	std::vector<float> ax, ay, az;
+	std::vector<float> fx, fy, fz;
+	std::vector<float> inverseMass;
+	std::vector<float> drag;
+
+	//Rotation of each body during the step, in degrees.
+	std::vector<float> rx, ry, rz;
+
+	//Linear and angular speed of each body at the beginning of the step, for the sleep test.
+	std::vector<float> speed;
+	std::vector<float> angularSpeed;
+
+	//World position before the step, the difference with px, py, pz is written back.
+	std::vector<glm::vec3> start;
+
+public:
+
+	/// <summary>
+	/// Integrate the bodies for one step.
+	/// </summary>
+	/// <param name="elems">The rigidbodies of the scene</param>
+	/// <param name="delta">Time of the step</param>
+	/// <param name="pool">The job pool for the chunks, nullptr to integrate on the calling thread</param>
+	void Step(const std::vector<Rigidbody*>& elems, double delta, JobPool* pool) {
+		Step(elems, delta, pool, [](Rigidbody*, glm::vec3, glm::vec3&) { return 1.0f; });
+	}
+
+	/// <summary>
+	/// Integrate the bodies for one step, with continuous collision detection.
+	/// </summary>
+	/// <param name="elems">The rigidbodies of the scene</param>
+	/// <param name="delta">Time of the step</param>
+	/// <param name="pool">The job pool for the chunks, nullptr to integrate on the calling thread</param>
+	/// <param name="sweep">Function (Rigidbody*, glm::vec3 displacement, glm::vec3 normal out) -> float, the time of impact in [0, 1] of the displacement (1 if none) and the normal of the impact.</param>
+	template<class Sweep>
+	void Step(const std::vector<Rigidbody*>& elems, double delta, JobPool* pool, Sweep sweep) {
+		float dt = (float)delta;
+		Gather(elems);
+
+		size_t count = this->bodies.size();
+		if (pool != nullptr) {
+			pool->ParallelFor(count, this->chunkSize, [this, dt](size_t begin, size_t end) {
+				Integrate(begin, end, dt);
+			});
+		}
+		else {
+			Integrate(0, count, dt);
+		}
+
+		Scatter(dt, sweep);
+	}
+
+	/// <summary>
+	/// Set the gravity applied to the bodies with gravity enabled.
+	/// </summary>
+	/// <param name="gravity">The gravity acceleration</param>
+	void SetGravity(glm::vec3 gravity) {
+		this->gravity = gravity;
+	}
+
+	/// <summary>
+	/// Return the gravity applied to the bodies with gravity enabled.
+	/// </summary>
+	/// <returns>The gravity acceleration</returns>
+	glm::vec3 GetGravity() {
+		return this->gravity;
+	}
+
+	/// <summary>
+	/// Return the number of bodies integrated on the last step.
+	/// </summary>
+	/// <returns>The number of bodies</returns>
+	size_t GetNbBodies() {
+		return this->bodies.size();
+	}
+
+protected:
+
+	/// <summary>
+	/// Fill the SoA arrays with the awake bodies.
+	/// </summary>
+	void Gather(const std::vector<Rigidbody*>& elems) {
+		this->bodies.clear();
+		for (size_t i = 0, max = elems.size(); i < max; i++) {
+			if (elems[i]->BeginStep()) {
+				this->bodies.push_back(elems[i]);
+			}
+		}
+
+		size_t count = this->bodies.size();
+		for (std::vector<float>* a : { &px, &py, &pz, &vx, &vy, &vz, &wx, &wy, &wz, &rx, &ry, &rz, &ax, &ay, &az, &fx, &fy, &fz, &inverseMass, &drag, &speed, &angularSpeed }) {
+			a->resize(count);
+		}
+		this->start.resize(count);
+
+		for (size_t i = 0; i < count; i++) {
+			Rigidbody* b = this->bodies[i];
+			glm::vec3 p = b->attachment->GetPositionWithRecursiveMatrix();
+			glm::vec3 v = b->GetVelocity();
+			glm::vec3 w = b->GetAngularVelocity();
+			glm::vec3 a = b->GetStepAcceleration(this->gravity);
+			glm::vec3 f = b->GetForce();
+			this->start[i] = p;
+			this->px[i] = p.x; this->py[i] = p.y; this->pz[i] = p.z;
+			this->vx[i] = v.x; this->vy[i] = v.y; this->vz[i] = v.z;
+			this->wx[i] = w.x; this->wy[i] = w.y; this->wz[i] = w.z;
+			this->ax[i] = a.x; this->ay[i] = a.y; this->az[i] = a.z;
+			this->fx[i] = f.x; this->fy[i] = f.y; this->fz[i] = f.z;
+			this->inverseMass[i] = b->GetInverseMass();
+			this->drag[i] = b->GetDrag();
+		}
+	}
+
+	/// <summary>
+	/// Integrate the bodies [begin, end), SIMD lanes first then the scalar remainder.
+	/// Move with the velocity resolved by the contact solver on the last step, then apply the accelerations and the drag for the next solve.
+	/// </summary>
+	void Integrate(size_t begin, size_t end, float dt) {
+		size_t i = begin;
+#if defined(SIMD_ENABLED)
+		for (; i + SimdLane::WIDTH <= end; i += SimdLane::WIDTH) {
+			Kernel(SimdLane(), i, dt);
+		}
+#endif
+		for (; i < end; i++) {
+			Kernel(SimdScalar(), i, dt);
+		}
+	}
+
+	/// <summary>
+	/// Integrate Ops::WIDTH bodies from index i.
+	/// </summary>
+	template<class Ops>
+	void Kernel(Ops, size_t i, float dt) {
+		typedef typename Ops::Reg Reg;
+		Reg t = Ops::Set(dt);
+		Reg one = Ops::Set(1.0f);
+
+		Reg v[3] = { Ops::Load(&vx[i]), Ops::Load(&vy[i]), Ops::Load(&vz[i]) };
+		Reg a[3] = { Ops::Load(&ax[i]), Ops::Load(&ay[i]), Ops::Load(&az[i]) };
+		Reg f[3] = { Ops::Load(&fx[i]), Ops::Load(&fy[i]), Ops::Load(&fz[i]) };
+		float* p[3] = { &px[i], &py[i], &pz[i] };
+		float* vOut[3] = { &vx[i], &vy[i], &vz[i] };
+		float* w[3] = { &wx[i], &wy[i], &wz[i] };
+		float* r[3] = { &rx[i], &ry[i], &rz[i] };
+
+		Reg im = Ops::Load(&inverseMass[i]);
+		Reg damping = Ops::Div(one, Ops::Add(one, Ops::Mul(Ops::Load(&drag[i]), t)));
+
+		Reg speed2 = Ops::Set(0.0f);
+		Reg angularSpeed2 = Ops::Set(0.0f);
+		for (int k = 0; k < 3; k++) {
+			Ops::Store(p[k], Ops::Add(Ops::Load(p[k]), Ops::Mul(v[k], t)));
+			speed2 = Ops::Add(speed2, Ops::Mul(v[k], v[k]));
+
+			Reg acc = Ops::Add(a[k], Ops::Mul(f[k], im));
+			Ops::Store(vOut[k], Ops::Mul(Ops::Add(v[k], Ops::Mul(acc, t)), damping));
+
+			Reg wk = Ops::Load(w[k]);
+			Ops::Store(r[k], Ops::Mul(wk, t));
+			angularSpeed2 = Ops::Add(angularSpeed2, Ops::Mul(wk, wk));
+			Ops::Store(w[k], Ops::Mul(wk, damping));
+		}
+		Ops::Store(&speed[i], Ops::Sqrt(speed2));
+		Ops::Store(&angularSpeed[i], Ops::Sqrt(angularSpeed2));
+	}
+
+	/// <summary>
+	/// Write the results back to the bodies and their transformations.
+	/// A continuous body stop at its first impact, and lose its velocity toward the hit surface.
+	/// </summary>
+	template<class Sweep>
+	void Scatter(float dt, Sweep& sweep) {
+		for (size_t i = 0, max = this->bodies.size(); i < max; i++) {
+			Rigidbody* b = this->bodies[i];
+			glm::vec3 d = glm::vec3(this->px[i], this->py[i], this->pz[i]) - this->start[i];
+			glm::vec3 v = glm::vec3(this->vx[i], this->vy[i], this->vz[i]);
+
+			if (b->IsCCD() && d != glm::vec3(0)) {
+				glm::vec3 normal = glm::vec3(0);
+				float toi = sweep(b, d, normal);
+				if (toi < 1.0f) {
+					d *= toi;
+					float vn = glm::dot(v, normal);
+					if (vn < 0.0f) {
+						v -= normal * vn;
+					}
+				}
+			}
+
+			glm::vec3 r = glm::vec3(this->rx[i], this->ry[i], this->rz[i]);
+			glm::vec3 w = glm::vec3(this->wx[i], this->wy[i], this->wz[i]);
+			b->EndStep(d, v, this->speed[i], r, w, this->angularSpeed[i], dt);
+		}
+	}
+};
+
+#endif // !__INTEGRATOR_HPP__
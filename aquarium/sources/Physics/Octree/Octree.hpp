@@ -248,6 +248,16 @@ public:
 				}
 			}
 		}
+		else if (type == ICollider::Type::ConvexHull) {
+			glm::vec3 pMin, pMax;
+			collider->GetWorldBounds(pMin, pMax);
+			glm::vec3 cMin = current.pos - glm::vec3(current.radius);
+			glm::vec3 cMax = current.pos + glm::vec3(current.radius);
+
+			fit = pMin.x >= cMin.x && pMax.x <= cMax.x &&
+				pMin.y >= cMin.y && pMax.y <= cMax.y &&
+				pMin.z >= cMin.z && pMax.z <= cMax.z;
+		}
 		return fit;
 	}
 
@@ -0,0 +1,485 @@
+#ifndef __PAIR_CACHE_HPP__
+#define __PAIR_CACHE_HPP__
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include <Engine/Tools/JobPool.hpp>
+#include <Physics/CollisionDetection.hpp>
+#include <Physics/BatchDetection.hpp>
+#include <Physics/CollisionBehavior.hpp>
+
+/// <summary>
+/// Persistent cache of the overlapping collider pairs.
+/// The broadphase is a sweep and prune on the X axis, kept sorted from a frame to another.
+/// A pair is only tested again if one of its colliders moved, and the GJK start from the simplex of the last test (the spheres and the pairs of boxes without rotation keep their analytic tests).
+/// The moved pairs of spheres and boxes are first tested together by shape pair with the SIMD kernels of BatchDetection, only the overlapping ones get the exact test.
+/// The narrowphase is split in fixed chunks of pairs across the JobPool, each chunk fill its own buffers, merged in chunk order so the result does not depend on the number of threads.
+/// The changes of state are sent to the CollisionBehavior of the gameobjects (enter, stay, exit), from the calling thread.
+/// </summary>
+class PairCache {
+public:
+
+	/// <summary>
+	/// State of a pair of colliders, kept while their AABB overlap.
+	/// </summary>
+	struct Pair {
+		/// <param name="one">The first collider (lowest address).</param>
+		/// <param name="two">The second collider.</param>
+		/// <param name="data">The result of the last test.</param>
+		/// <param name="simplex">The simplex of the last GJK test, the warm start of the next one.</param>
+		/// <param name="versionOne">The world version of one at the last test.</param>
+		/// <param name="versionTwo">The world version of two at the last test.</param>
+		/// <param name="frame">The last frame where the pair was in the broadphase.</param>
+		/// <param name="wasColliding">The collision state before the last update.</param>
+		ICollider* one = nullptr;
+		ICollider* two = nullptr;
+		CollisionDetection::Data data = CollisionDetection::Data(false, glm::vec3(0));
+		GJK::Simplex simplex;
+		uint64_t versionOne = UINT64_MAX;
+		uint64_t versionTwo = UINT64_MAX;
+		uint64_t frame = 0;
+		bool wasColliding = false;
+	};
+
+protected:
+
+	/// <summary>
+	/// Key of a pair, the two colliders ordered by address.
+	/// </summary>
+	struct Key {
+		ICollider* one;
+		ICollider* two;
+
+		bool operator==(const Key& other) const {
+			return this->one == other.one && this->two == other.two;
+		}
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& k) const {
+			size_t h1 = std::hash<ICollider*>()(k.one);
+			size_t h2 = std::hash<ICollider*>()(k.two);
+			return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
+		}
+	};
+
+	/// <summary>
+	/// An element of the sweep and prune list.
+	/// </summary>
+	struct Entry {
+		ICollider* collider;
+		glm::vec3 min;
+		glm::vec3 max;
+	};
+
+	/// <summary>
+	/// Output buffers of a narrowphase chunk.
+	/// </summary>
+	struct Chunk {
+		std::vector<Pair*> colliding;
+		std::vector<Pair*> separated;
+		size_t nbTests = 0;
+		size_t nbSkipped = 0;
+	};
+
+	std::unordered_map<Key, Pair, KeyHash> pairs;
+
+	//Pairs overlapping in the broadphase this frame, in sweep order, and the narrowphase chunks.
+	std::vector<Pair*> candidates;
+	std::vector<Chunk> chunks;
+
+	//The result of the batched test of each candidate, 0 if the pair is proved separated.
+	std::vector<uint8_t> overlap;
+
+	//The batches of the moved candidates by shape pair, and their index in the candidates.
+	BatchDetection::SphereBatch spheresOne, spheresTwo;
+	std::vector<uint32_t> sphereSpherePairs;
+	BatchDetection::SphereBatch localSpheres; // the sphere in the frame of the box
+	BatchDetection::AABBBatch localBoxes;
+	std::vector<uint32_t> sphereBoxPairs;
+	BatchDetection::AABBBatch alignedOne, alignedTwo; // the pairs of boxes without rotation
+	std::vector<uint32_t> alignedPairs;
+	BatchDetection::OBBBatch boxesOne, boxesTwo;
+	std::vector<uint32_t> boxBoxPairs;
+	std::vector<uint8_t> batchResult;
+	float batchMargin = 1e-4f;
+
+	//Number of pairs of a chunk, fixed so the chunks are the same whatever the number of threads.
+	size_t chunkSize = 64;
+
+	//Colliding pairs of the last update, in broadphase order (the elements of an unordered_map keep their address).
+	std::vector<Pair*> colliding;
+
+	//Sweep and prune list, sorted on min.x, the order of the previous frame is kept so the sort is almost free.
+	std::vector<Entry> sweep;
+
+	uint64_t frame = 0;
+
+	//Number of narrowphase tests done and skipped on the last update.
+	size_t nbTests = 0;
+	size_t nbSkipped = 0;
+
+public:
+
+	/// <summary>
+	/// Update the pairs with the colliders of the current frame, and send the collision events.
+	/// </summary>
+	/// <param name="colliders">The colliders of the scene, with an up to date world cache.</param>
+	/// <param name="filter">Predicate (ICollider*, ICollider*) -> bool, false if the pair must be ignored (e.g. layers).</param>
+	/// <param name="pool">The job pool for the narrowphase, nullptr to test the pairs on the calling thread.</param>
+	template<class Filter>
+	void Update(const std::vector<ICollider*>& colliders, Filter filter, JobPool* pool = nullptr) {
+		this->frame++;
+		this->nbTests = 0;
+		this->nbSkipped = 0;
+		this->colliding.clear();
+		this->candidates.clear();
+
+		std::unordered_set<ICollider*> alive(colliders.begin(), colliders.end());
+		UpdateSweep(colliders, alive);
+
+		for (size_t i = 0, max = colliders.size(); i < max; i++) {
+			colliders[i]->SetCollision(false);
+		}
+
+		for (size_t i = 0, max = this->sweep.size(); i < max; i++) {
+			const Entry& a = this->sweep[i];
+			for (size_t j = i + 1; j < max && this->sweep[j].min.x <= a.max.x; j++) {
+				const Entry& b = this->sweep[j];
+				if (a.max.y < b.min.y || b.max.y < a.min.y || a.max.z < b.min.z || b.max.z < a.min.z) {
+					continue;
+				}
+				if (a.collider->attachment == b.collider->attachment || !filter(a.collider, b.collider)) {
+					continue;
+				}
+
+				Key key = a.collider < b.collider ? Key{ a.collider, b.collider } : Key{ b.collider, a.collider };
+				auto it = this->pairs.find(key);
+				if (it == this->pairs.end()) {
+					Pair p;
+					p.one = key.one;
+					p.two = key.two;
+					it = this->pairs.emplace(key, p).first;
+				}
+				it->second.frame = this->frame;
+				this->candidates.push_back(&it->second);
+			}
+		}
+
+		Narrowphase(pool);
+		Merge();
+
+		//Pairs no more in the broadphase, send the exit events if the colliders still exist.
+		for (auto it = this->pairs.begin(); it != this->pairs.end();) {
+			Pair& p = it->second;
+			if (p.frame != this->frame) {
+				if (p.data.collision && alive.count(p.one) > 0 && alive.count(p.two) > 0) {
+					Notify(p, &CollisionBehavior::OnCollisionExit);
+				}
+				it = this->pairs.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Remove every pair, without events.
+	/// </summary>
+	void Clear() {
+		this->pairs.clear();
+		this->sweep.clear();
+		this->colliding.clear();
+	}
+
+	/// <summary>
+	/// Return the number of pairs overlapping in the broadphase.
+	/// </summary>
+	/// <returns>The number of pairs</returns>
+	size_t GetNbPairs() {
+		return this->pairs.size();
+	}
+
+	/// <summary>
+	/// Return the number of narrowphase tests done on the last update.
+	/// </summary>
+	/// <returns>The number of tests</returns>
+	size_t GetNbTests() {
+		return this->nbTests;
+	}
+
+	/// <summary>
+	/// Return the number of narrowphase tests skipped on the last update, because the pair did not move.
+	/// </summary>
+	/// <returns>The number of skipped tests</returns>
+	size_t GetNbSkipped() {
+		return this->nbSkipped;
+	}
+
+	/// <summary>
+	/// Return the colliding pairs of the last update, in a stable order.
+	/// </summary>
+	/// <returns>The list of colliding pairs</returns>
+	const std::vector<Pair*>& GetCollidingPairs() {
+		return this->colliding;
+	}
+
+protected:
+
+	/// <summary>
+	/// Refresh the sweep list: remove the dead colliders, add the new ones, update the bounds and sort on min.x.
+	/// </summary>
+	void UpdateSweep(const std::vector<ICollider*>& colliders, const std::unordered_set<ICollider*>& alive) {
+		std::unordered_set<ICollider*> known;
+		size_t count = 0;
+		for (size_t i = 0, max = this->sweep.size(); i < max; i++) {
+			if (alive.count(this->sweep[i].collider) > 0 && known.insert(this->sweep[i].collider).second) {
+				this->sweep[count++] = this->sweep[i];
+			}
+		}
+		this->sweep.resize(count);
+
+		for (size_t i = 0, max = colliders.size(); i < max; i++) {
+			if (known.insert(colliders[i]).second) {
+				this->sweep.push_back(Entry{ colliders[i], glm::vec3(0), glm::vec3(0) });
+			}
+		}
+
+		for (size_t i = 0, max = this->sweep.size(); i < max; i++) {
+			this->sweep[i].collider->GetWorldBounds(this->sweep[i].min, this->sweep[i].max);
+		}
+
+		//Insertion sort, nearly linear as the objects move little between two frames.
+		for (size_t i = 1, max = this->sweep.size(); i < max; i++) {
+			Entry e = this->sweep[i];
+			size_t j = i;
+			while (j > 0 && this->sweep[j - 1].min.x > e.min.x) {
+				this->sweep[j] = this->sweep[j - 1];
+				j--;
+			}
+			this->sweep[j] = e;
+		}
+	}
+
+	/// <summary>
+	/// Test the candidate pairs by chunks, across the pool.
+	/// The world caches are all up to date (read by the sweep), so the tests only read the colliders and each pair is written by one chunk.
+	/// </summary>
+	/// <param name="pool">The job pool, nullptr to test on the calling thread</param>
+	void Narrowphase(JobPool* pool) {
+		BatchTest();
+
+		size_t nbChunks = (this->candidates.size() + this->chunkSize - 1) / this->chunkSize;
+		this->chunks.resize(nbChunks);
+
+		auto run = [this](size_t begin, size_t end) {
+			for (size_t c = begin; c < end; c++) {
+				TestChunk(c);
+			}
+		};
+		if (pool != nullptr) {
+			pool->ParallelFor(nbChunks, 1, run);
+		}
+		else {
+			run(0, nbChunks);
+		}
+	}
+
+	/// <summary>
+	/// Test the moved candidates of spheres and boxes with the SIMD kernels, grouped by shape pair, and fill overlap.
+	/// The radii and the boxes without rotation are grown by batchMargin, so a pair on the boundary is left to the exact test: a pair the kernels keep may still be separated, never the reverse.
+	/// </summary>
+	void BatchTest() {
+		this->overlap.assign(this->candidates.size(), 1);
+		this->spheresOne.Clear();
+		this->spheresTwo.Clear();
+		this->localSpheres.Clear();
+		this->localBoxes.Clear();
+		this->alignedOne.Clear();
+		this->alignedTwo.Clear();
+		this->boxesOne.Clear();
+		this->boxesTwo.Clear();
+		this->sphereSpherePairs.clear();
+		this->sphereBoxPairs.clear();
+		this->alignedPairs.clear();
+		this->boxBoxPairs.clear();
+
+		for (size_t i = 0, max = this->candidates.size(); i < max; i++) {
+			Pair& p = *this->candidates[i];
+			if (p.one->GetWorldVersion() == p.versionOne && p.two->GetWorldVersion() == p.versionTwo) {
+				continue;
+			}
+			ICollider::Type t1 = p.one->ColliderType();
+			ICollider::Type t2 = p.two->ColliderType();
+			if (t1 == ICollider::Sphere && t2 == ICollider::Sphere) {
+				const SphereCollider::WorldCache& w1 = static_cast<SphereCollider*>(p.one)->GetWorld();
+				const SphereCollider::WorldCache& w2 = static_cast<SphereCollider*>(p.two)->GetWorld();
+				this->spheresOne.Push(w1.center, w1.radius + this->batchMargin);
+				this->spheresTwo.Push(w2.center, w2.radius + this->batchMargin);
+				this->sphereSpherePairs.push_back((uint32_t)i);
+			}
+			else if ((t1 == ICollider::Sphere && t2 == ICollider::BoundingBox) || (t1 == ICollider::BoundingBox && t2 == ICollider::Sphere)) {
+				SphereCollider* sphere = static_cast<SphereCollider*>(t1 == ICollider::Sphere ? p.one : p.two);
+				BoundingBoxCollider* box = static_cast<BoundingBoxCollider*>(t1 == ICollider::Sphere ? p.two : p.one);
+				const BoundingBoxCollider::WorldCache& w = box->GetWorld();
+				glm::vec3 d = sphere->GetWorld().center - w.center;
+				this->localSpheres.Push(glm::vec3(glm::dot(d, w.axis[0]), glm::dot(d, w.axis[1]), glm::dot(d, w.axis[2])), sphere->GetWorld().radius + this->batchMargin);
+				this->localBoxes.Push(-w.halfSize, w.halfSize);
+				this->sphereBoxPairs.push_back((uint32_t)i);
+			}
+			else if (t1 == ICollider::BoundingBox && t2 == ICollider::BoundingBox && AxisAligned(p)) {
+				const BoundingBoxCollider::WorldCache& w1 = static_cast<BoundingBoxCollider*>(p.one)->GetWorld();
+				const BoundingBoxCollider::WorldCache& w2 = static_cast<BoundingBoxCollider*>(p.two)->GetWorld();
+				this->alignedOne.Push(w1.min - glm::vec3(this->batchMargin), w1.max + glm::vec3(this->batchMargin));
+				this->alignedTwo.Push(w2.min, w2.max);
+				this->alignedPairs.push_back((uint32_t)i);
+			}
+			else if (t1 == ICollider::BoundingBox && t2 == ICollider::BoundingBox) {
+				this->boxesOne.Push(static_cast<BoundingBoxCollider*>(p.one));
+				this->boxesTwo.Push(static_cast<BoundingBoxCollider*>(p.two));
+				this->boxBoxPairs.push_back((uint32_t)i);
+			}
+		}
+
+		BatchDetection::SphereSphere(this->spheresOne, this->spheresTwo, this->batchResult);
+		Scatter(this->sphereSpherePairs);
+		BatchDetection::SphereAABB(this->localSpheres, this->localBoxes, this->batchResult);
+		Scatter(this->sphereBoxPairs);
+		BatchDetection::AABBAABB(this->alignedOne, this->alignedTwo, this->batchResult);
+		Scatter(this->alignedPairs);
+		BatchDetection::OBBOBB(this->boxesOne, this->boxesTwo, this->batchResult);
+		Scatter(this->boxBoxPairs);
+	}
+
+	/// <summary>
+	/// Write the result of a batch to the overlap of its candidates.
+	/// </summary>
+	/// <param name="indices">The index in the candidates of each pair of the batch</param>
+	void Scatter(const std::vector<uint32_t>& indices) {
+		for (size_t k = 0, max = indices.size(); k < max; k++) {
+			this->overlap[indices[k]] = this->batchResult[k];
+		}
+	}
+
+	/// <summary>
+	/// Test the pairs of a chunk whose colliders moved since the last test, and fill the buffers of the chunk.
+	/// </summary>
+	/// <param name="c">The index of the chunk</param>
+	void TestChunk(size_t c) {
+		Chunk& chunk = this->chunks[c];
+		chunk.colliding.clear();
+		chunk.separated.clear();
+		chunk.nbTests = 0;
+		chunk.nbSkipped = 0;
+
+		for (size_t i = c * this->chunkSize, max = std::min(this->candidates.size(), (c + 1) * this->chunkSize); i < max; i++) {
+			Pair& p = *this->candidates[i];
+			p.wasColliding = p.data.collision;
+
+			uint64_t v1 = p.one->GetWorldVersion();
+			uint64_t v2 = p.two->GetWorldVersion();
+			if (v1 != p.versionOne || v2 != p.versionTwo) {
+				p.data = this->overlap[i] != 0 ? Test(p) : CollisionDetection::Data(false, glm::vec3(0));
+				p.versionOne = v1;
+				p.versionTwo = v2;
+				chunk.nbTests++;
+			}
+			else {
+				chunk.nbSkipped++;
+			}
+
+			if (p.data.collision) {
+				chunk.colliding.push_back(&p);
+			}
+			else if (p.wasColliding) {
+				chunk.separated.push_back(&p);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Merge the chunk buffers in chunk order, and send the events.
+	/// </summary>
+	void Merge() {
+		for (const Chunk& chunk : this->chunks) {
+			this->nbTests += chunk.nbTests;
+			this->nbSkipped += chunk.nbSkipped;
+			for (Pair* p : chunk.colliding) {
+				this->colliding.push_back(p);
+				p->one->SetCollision(true);
+				p->two->SetCollision(true);
+				Notify(*p, p->wasColliding ? &CollisionBehavior::OnCollisionStay : &CollisionBehavior::OnCollisionEnter);
+			}
+			for (Pair* p : chunk.separated) {
+				Notify(*p, &CollisionBehavior::OnCollisionExit);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Return if the two boxes of a pair have no rotation, their exact test is then the AABB test.
+	/// </summary>
+	/// <param name="p">A pair of BoundingBoxCollider</param>
+	/// <returns>If both boxes are axis aligned</returns>
+	static bool AxisAligned(const Pair& p) {
+		const BoundingBoxCollider::WorldCache& w1 = static_cast<BoundingBoxCollider*>(p.one)->GetWorld();
+		const BoundingBoxCollider::WorldCache& w2 = static_cast<BoundingBoxCollider*>(p.two)->GetWorld();
+		for (int i = 0; i < 3; i++) {
+			if (w1.axis[i][i] < 1.0f - 1e-6f || w2.axis[i][i] < 1.0f - 1e-6f) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Narrowphase of a pair, depending on the collider types.
+	/// </summary>
+	/// <param name="p">The pair</param>
+	/// <returns>The Data of the collision.</returns>
+	CollisionDetection::Data Test(Pair& p) {
+		ICollider::Type t1 = p.one->ColliderType();
+		ICollider::Type t2 = p.two->ColliderType();
+
+		if (t1 == ICollider::Sphere && t2 == ICollider::Sphere) {
+			return CollisionDetection::Sphere_Sphere(static_cast<SphereCollider*>(p.one), static_cast<SphereCollider*>(p.two));
+		}
+		else if (t1 == ICollider::Sphere && t2 == ICollider::BoundingBox) {
+			return CollisionDetection::Sphere_OBB(static_cast<SphereCollider*>(p.one), static_cast<BoundingBoxCollider*>(p.two));
+		}
+		else if (t1 == ICollider::BoundingBox && t2 == ICollider::Sphere) {
+			CollisionDetection::Data d = CollisionDetection::Sphere_OBB(static_cast<SphereCollider*>(p.two), static_cast<BoundingBoxCollider*>(p.one));
+			d.normal = -d.normal;
+			return d;
+		}
+		else if (t1 == ICollider::BoundingBox && t2 == ICollider::BoundingBox && AxisAligned(p)) {
+			return CollisionDetection::AABB_AABB(static_cast<BoundingBoxCollider*>(p.one), static_cast<BoundingBoxCollider*>(p.two));
+		}
+		//Box - box and every pair with a convex hull, the GJK warm started with the simplex of the pair.
+		return CollisionDetection::Convex_Convex(p.one, p.two, p.simplex);
+	}
+
+	/// <summary>
+	/// Call an event on the CollisionBehavior of the two gameobjects of a pair.
+	/// </summary>
+	/// <param name="p">The pair</param>
+	/// <param name="event">The event to call</param>
+	void Notify(Pair& p, void (CollisionBehavior::* event)(CollisionBehavior::Collision)) {
+		std::vector<CollisionBehavior*> b1 = p.one->attachment->getComponentsByType<CollisionBehavior>();
+		for (size_t i = 0, max = b1.size(); i < max; i++) {
+			(b1[i]->*event)(CollisionBehavior::Collision{ p.one, p.two, p.data.closestPoint });
+		}
+		std::vector<CollisionBehavior*> b2 = p.two->attachment->getComponentsByType<CollisionBehavior>();
+		for (size_t i = 0, max = b2.size(); i < max; i++) {
+			(b2[i]->*event)(CollisionBehavior::Collision{ p.two, p.one, p.data.closestPoint });
+		}
+	}
+};
+
+#endif // !__PAIR_CACHE_HPP__
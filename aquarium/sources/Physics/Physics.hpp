@@ -7,6 +7,10 @@
 #include <Engine/Engine.hpp>
 #include <Physics/Physics/CPhysic.hpp>
 #include <Physics/CollisionDetection.hpp>
+#include <Physics/PairCache.hpp>
+#include <Physics/ContactSolver.hpp>
+#include <Physics/Integrator.hpp>
+#include <Physics/Physics/WaterSolver.hpp>
 
 SettedShaders settedPhysicsShaders;
 
@@ -28,11 +32,15 @@ public:
 		/// <param name="obj">The Object hitted by the raycast.</param>
 		/// <param name="hitPosition">The Coordinate of the hit.</param>
 		/// <param name="vertexIndex"> The index of the nearest vertex of the hitted object.</param>
+		/// <param name="triangle"> The index of the hitted triangle of the model, -1 if only the bounding box was hitted.</param>
+		/// <param name="barycentric"> The barycentric coordinates of the hit in the hitted triangle.</param>
 		bool hit;
 		GameObject* obj;
 		glm::vec3 hitPosition;
 		int nearestVertex;
 		double distance;
+		int triangle = -1;
+		glm::vec3 barycentric = glm::vec3(0);
 
 
 		RaycastHit(bool hit, GameObject* obj, glm::vec3 hitPosition, int vertexIndex, double distance = std::numeric_limits<double>::max()) {
@@ -46,6 +54,17 @@ public:
 	};
 protected:
 
+	/// <summary>
+	/// An object tested by the batch raycasts, with its world bounding box and the BVH of its model (nullptr if none).
+	/// </summary>
+	struct RaycastTarget {
+		GameObject* obj = nullptr;
+		glm::vec3 min = glm::vec3(0);
+		glm::vec3 max = glm::vec3(0);
+		MeshBVH* bvh = nullptr;
+		glm::mat4 invModel = glm::mat4(1);
+	};
+
 	/// <summary>
 	/// Layer collision matrix, store if an element collide with another one, using binary, with a list of 32, 32bit int (giving a total of 32 layer possible)
 	/// </summary>
@@ -56,6 +75,21 @@ protected:
 	/// </summary>
 	CollisionDetection detection;
 
+	/// <summary>
+	/// Overlapping pairs kept from a frame to another, send the collision events.
+	/// </summary>
+	PairCache pairCache;
+
+	/// <summary>
+	/// Resolve the contacts of the colliding rigidbodies, island by island.
+	/// </summary>
+	ContactSolver solver;
+
+	/// <summary>
+	/// Integrate the rigidbodies together, in world space.
+	/// </summary>
+	Integrator integrator;
+
 	//Octree* octree = nullptr; // Use way too much execution time and developpment time for this project.
 
 	float addDropCooldown = 0.0f;
@@ -79,13 +113,31 @@ public:
 
 	/// <summary>
 	/// Compute the physics for a scene, with a root Gameobject.
+	/// One step per frame, the fast rigidbodies use the continuous collision detection instead of sub steps.
 	/// </summary>
 	/// <param name="deltatime">Time since last frame.</param>
 	/// <param name="root">Root gameobject of the scene, or another gameobject.</param>
-	/// <param name="nbStep">Number of computing steps for the physics.</param>
-	void Compute(double deltatime, GameObject* root, int nbStep = 1) {
+	void Compute(double deltatime, GameObject* root) {
+		std::vector<ICollider*> colliders = root->getComponentsByTypeRecursive<ICollider>(true);
+
+		this->Compute(deltatime, root->getComponentsByTypeRecursive<CPhysic>(), colliders);
 
-		this->Compute(deltatime, root->getComponentsByTypeRecursive<CPhysic>(), nbStep);
+		this->UpdateWorldCaches(colliders);
+		this->pairCache.Update(colliders, [this](ICollider* a, ICollider* b) {
+			return IsPhysicsBetweenLayers(a->attachment->GetLayer(), b->attachment->GetLayer());
+		}, JobPool::Main());
+		this->solver.Solve(this->pairCache.GetCollidingPairs(), deltatime, JobPool::Main());
+	}
+
+	/// <summary>
+	/// Start a new physics frame and compute the world space data of each collider once, read by all the detection functions of the frame.
+	/// </summary>
+	/// <param name="colliders">The colliders of the scene.</param>
+	void UpdateWorldCaches(std::vector<ICollider*> colliders) {
+		ICollider::NextWorldFrame();
+		for (size_t i = 0, max = colliders.size(); i < max; i++) {
+			colliders[i]->UpdateWorldCache();
+		}
 	}
 
 	/// <summary>
@@ -93,34 +145,45 @@ public:
 	/// </summary>
 	/// <param name="deltatime">Time since last frame.</param>
 	/// <param name="elems">CPhysic elements for Physics Computing.</param>
-	/// <param name="nbStep">Number of computing steps for the physics.</param>
-	void Compute(double deltatime, std::vector<CPhysic*> elems, int nbStep = 1) {
+	/// <param name="colliders">Colliders the continuous rigidbodies are swept against.</param>
+	void Compute(double deltatime, std::vector<CPhysic*> elems, const std::vector<ICollider*>& colliders = std::vector<ICollider*>()) {
 		glDisable(GL_BLEND);
 		addDropCooldown -= deltatime;
-		double stepDelta = deltatime / (double)nbStep;
-
-
-		for (int i = 0; i < nbStep; i++) {
-			double currentStep = stepDelta * ((double)(i + 1));
 
-			for (size_t j = 0, max = elems.size(); j < max; j++) {
-				elems[j]->Compute(currentStep);
+		std::vector<Rigidbody*> bodies;
+		bool continuous = false;
+		for (size_t j = 0, max = elems.size(); j < max; j++) {
+			Rigidbody* body = dynamic_cast<Rigidbody*>(elems[j]);
+			if (body != nullptr) {
+				bodies.push_back(body);
+				continuous |= body->IsCCD() && !body->IsSleeping();
 			}
+			else {
+				elems[j]->Compute(deltatime);
+			}
+		}
 
-			/*octree->Refresh(octree);
-			std::vector<OctreeCollisionPossibility> octreePossibility = octree->GetAllCollisionPossibility();
-			for (size_t j = 0, max = octreePossibility.size(); j < max; j++) {
-				std::vector<GameObject*> possibility = octreePossibility[j].possibleCollisions;
-				for (int k = 0, maxK = possibility.size(); k < maxK; k++) {
-					for (int l = k + 1; l < maxK; l++) {
-						// test collision between k et l.
-						if (IsPhysicsBetweenLayers(possibility[k]->GetLayer(), possibility[l]->GetLayer())) {
-							CollisionDetection::Data data = detection.Detection(possibility[k], possibility[l]);
-						}
+		//The sweeps read the colliders at the beginning of the step.
+		if (continuous) {
+			this->UpdateWorldCaches(colliders);
+		}
+		this->integrator.Step(bodies, deltatime, JobPool::Main(), [this, &colliders](Rigidbody* body, glm::vec3 displacement, glm::vec3& normal) {
+			return this->TimeOfImpact(body, displacement, colliders, normal);
+		});
+
+		/*octree->Refresh(octree);
+		std::vector<OctreeCollisionPossibility> octreePossibility = octree->GetAllCollisionPossibility();
+		for (size_t j = 0, max = octreePossibility.size(); j < max; j++) {
+			std::vector<GameObject*> possibility = octreePossibility[j].possibleCollisions;
+			for (int k = 0, maxK = possibility.size(); k < maxK; k++) {
+				for (int l = k + 1; l < maxK; l++) {
+					// test collision between k et l.
+					if (IsPhysicsBetweenLayers(possibility[k]->GetLayer(), possibility[l]->GetLayer())) {
+						CollisionDetection::Data data = detection.Detection(possibility[k], possibility[l]);
 					}
 				}
-			}*/
-		}
+			}
+		}*/
 		glEnable(GL_BLEND);
 	}
 
@@ -159,6 +222,13 @@ public:
 		return RaycastHit(false, nullptr, glm::vec3(0), -1);
 	}
 
+	/// <summary>
+	/// Do a raycast from origin in direction dir, the bounding box of each RaycastObject is tested first, then the triangles of its model.
+	/// </summary>
+	/// <param name="root">The root of the scene</param>
+	/// <param name="origin">The origin of the ray, in world space</param>
+	/// <param name="dir">The normalized direction of the ray, in world space</param>
+	/// <returns>Return a RaycastHit object that contain hit informations</returns>
 	RaycastHit Raycast(GameObject* root, glm::vec3 origin, glm::vec3 dir) {
 		std::vector<RaycastObject*> ro = root->getComponentsByTypeRecursive<RaycastObject>();
 
@@ -166,39 +236,145 @@ public:
 		for (size_t i = 0, max = ro.size(); i < max; i++) {
 			BoundingBoxCollider* bbc = ro[i]->attachment->getFirstComponentByType<BoundingBoxCollider>();
 			double val = -1;
-			int nearestVertex = -1;
 			if (bbc != nullptr) {
 				val = CollisionDetection::Ray_AABB(origin, dir, bbc);
 			}
 
-			if (val >= 0 && val < res.distance) {
+			if (val < 0 || val >= res.distance) {
+				continue;
+			}
+
+			Model* m = ro[i]->GetGameObject()->getFirstComponentByType<Model>();
+			if (m == nullptr || !m->HasFaces()) {
+				//No triangles to test, keep the bounding box hit.
 				res.distance = val;
 				res.hit = true;
 				res.obj = ro[i]->GetGameObject();
 				res.hitPosition = origin + (dir * (float)res.distance);
+				res.nearestVertex = -1;
+				res.triangle = -1;
+				continue;
+			}
+
+			//The ray is moved in the local space of the model, the direction is not normalized so the distance stay in world unit.
+			glm::mat4 invModel = glm::inverse(ro[i]->GetGameObject()->GetMatrixRecursive());
+			glm::vec3 localOrigin = glm::vec3(invModel * glm::vec4(origin, 1.0f));
+			glm::vec3 localDir = glm::vec3(invModel * glm::vec4(dir, 0.0f));
+
+			MeshBVH::Hit hit = m->GetBVH()->Raycast(localOrigin, localDir, (float)res.distance);
+			if (hit.hit) {
+				res.distance = hit.distance;
+				res.hit = true;
+				res.obj = ro[i]->GetGameObject();
+				res.hitPosition = origin + (dir * hit.distance);
+				res.triangle = hit.triangle;
+				res.barycentric = hit.barycentric;
+				res.nearestVertex = m->GetBVH()->GetNearestVertex(hit);
 			}
 		}
 
-		if (res.hit) {
-			Model* m = res.obj->getFirstComponentByType<Model>();
-			if (m != nullptr) {
-				std::vector<glm::vec3> pts = m->GetPoints();
-				unsigned int minPts = -1;
-				double minDist = std::numeric_limits<double>::max();
-				for (int i = 0, max = pts.size(); i < max; i++) {
-					double d = glm::distance(pts[i], res.hitPosition);
-					if (d < minDist) {
-						minPts = i;
-						minDist = d;
-					}
-				}
-				res.nearestVertex = minPts;
+		return res;
+	}
+
+	/// <summary>
+	/// Do a raycast for each ray of a list, the RaycastObjects are collected once for all the rays.
+	/// The rays are traversed by packets of MeshBVH::PACKET_SIZE, keep the coherent rays (same origin, close directions) next to each other.
+	/// </summary>
+	/// <param name="root">The root of the scene</param>
+	/// <param name="origins">The origin of each ray, in world space</param>
+	/// <param name="dirs">The normalized direction of each ray, in world space</param>
+	/// <returns>The RaycastHit of each ray</returns>
+	std::vector<RaycastHit> Raycast(GameObject* root, const std::vector<glm::vec3>& origins, const std::vector<glm::vec3>& dirs) {
+		std::vector<RaycastHit> res(origins.size(), RaycastHit(false, nullptr, glm::vec3(0), -1));
+
+		//The targets are prepared before the jobs, the BVH are built on the first call.
+		std::vector<RaycastTarget> targets;
+		std::vector<RaycastObject*> ro = root->getComponentsByTypeRecursive<RaycastObject>();
+		for (size_t i = 0, max = ro.size(); i < max; i++) {
+			BoundingBoxCollider* bbc = ro[i]->attachment->getFirstComponentByType<BoundingBoxCollider>();
+			if (bbc == nullptr) {
+				continue;
 			}
+			RaycastTarget t;
+			t.obj = ro[i]->GetGameObject();
+			bbc->GetMinMax(t.min, t.max);
+			Model* m = t.obj->getFirstComponentByType<Model>();
+			if (m != nullptr && m->HasFaces()) {
+				t.bvh = m->GetBVH();
+				t.invModel = glm::inverse(t.obj->GetMatrixRecursive());
+			}
+			targets.push_back(t);
 		}
+
+		JobPool::Main()->ParallelFor((origins.size() + MeshBVH::PACKET_SIZE - 1) / MeshBVH::PACKET_SIZE, 8, [&](size_t begin, size_t end) {
+			for (size_t p = begin; p < end; p++) {
+				size_t first = p * MeshBVH::PACKET_SIZE;
+				size_t count = std::min(origins.size() - first, (size_t)MeshBVH::PACKET_SIZE);
+				RaycastPacket(targets, &origins[first], &dirs[first], count, &res[first]);
+			}
+		});
+
 		return res;
 	}
 
 
+	/// <summary>
+	/// Raycast a packet of rays against the targets, the bounding boxes are tested with the whole packet then the rays hitting a box traverse its BVH together.
+	/// </summary>
+	/// <param name="targets">The raycast targets</param>
+	/// <param name="origins">The origins of the rays</param>
+	/// <param name="dirs">The directions of the rays</param>
+	/// <param name="count">The number of rays (MeshBVH::PACKET_SIZE max)</param>
+	/// <param name="res">The hits of the rays, updated if closer</param>
+	void RaycastPacket(const std::vector<RaycastTarget>& targets, const glm::vec3* origins, const glm::vec3* dirs, size_t count, RaycastHit* res) {
+		MeshBVH::RayPacket world;
+		for (size_t r = 0; r < count; r++) {
+			world.Push(origins[r], dirs[r]);
+		}
+
+		float tNear[MeshBVH::PACKET_SIZE];
+		MeshBVH::Hit hits[MeshBVH::PACKET_SIZE];
+		int rays[MeshBVH::PACKET_SIZE];
+		for (const RaycastTarget& t : targets) {
+			for (size_t r = 0; r < count; r++) {
+				world.maxDistance[r] = res[r].hit ? (float)res[r].distance : FLT_MAX;
+			}
+			int mask = MeshBVH::PacketBox(world, t.min, t.max, tNear);
+			if (mask == 0) {
+				continue;
+			}
+
+			if (t.bvh == nullptr) {
+				//No triangles to test, keep the bounding box hit.
+				for (size_t r = 0; r < count; r++) {
+					if ((mask & (1 << r)) != 0) {
+						res[r] = RaycastHit(true, t.obj, origins[r] + dirs[r] * tNear[r], -1, tNear[r]);
+					}
+				}
+				continue;
+			}
+
+			//The rays hitting the box are moved in the local space of the model, the directions are not normalized so the distances stay in world unit.
+			MeshBVH::RayPacket local;
+			for (size_t r = 0; r < count; r++) {
+				if ((mask & (1 << r)) != 0) {
+					rays[local.count] = (int)r;
+					local.Push(glm::vec3(t.invModel * glm::vec4(origins[r], 1.0f)), glm::vec3(t.invModel * glm::vec4(dirs[r], 0.0f)), world.maxDistance[r]);
+				}
+			}
+
+			t.bvh->RaycastPacket(local, hits);
+			for (int i = 0; i < local.count; i++) {
+				if (hits[i].hit) {
+					int r = rays[i];
+					res[r] = RaycastHit(true, t.obj, origins[r] + dirs[r] * hits[i].distance, t.bvh->GetNearestVertex(hits[i]), hits[i].distance);
+					res[r].triangle = hits[i].triangle;
+					res[r].barycentric = hits[i].barycentric;
+				}
+			}
+		}
+	}
+
 	/*void AddGameObjectToOctree(GameObject* gameobject) {
 		octree->Insert(gameobject);
 	}
@@ -235,6 +411,39 @@ public:
 		}
 	}
 
+	/// <summary>
+	/// Enable or disable the collisions between two layers (0 to 31), in both directions.
+	/// </summary>
+	/// <param name="l1">First layer</param>
+	/// <param name="l2">Second layer</param>
+	/// <param name="collide">Do the two layers collide ?</param>
+	void SetLayerCollision(uint_fast8_t l1, uint_fast8_t l2, bool collide) {
+		if (collide) {
+			layerCollisionMatrix[l1] |= (1u << l2);
+			layerCollisionMatrix[l2] |= (1u << l1);
+		}
+		else {
+			layerCollisionMatrix[l1] &= ~(1u << l2);
+			layerCollisionMatrix[l2] &= ~(1u << l1);
+		}
+	}
+
+	/// <summary>
+	/// Return the overlapping pair cache of the physics.
+	/// </summary>
+	/// <returns>The pair cache</returns>
+	PairCache* GetPairCache() {
+		return &this->pairCache;
+	}
+
+	/// <summary>
+	/// Set the gravity applied to the rigidbodies with gravity enabled.
+	/// </summary>
+	/// <param name="gravity">The gravity acceleration</param>
+	void SetGravity(glm::vec3 gravity) {
+		this->integrator.SetGravity(gravity);
+	}
+
 
 private:
 
@@ -248,6 +457,37 @@ private:
 		uint_fast32_t v = layerCollisionMatrix[l1];
 		return (v & (1 << l2)) > 0;
 	}
+
+	/// <summary>
+	/// Sweep the colliders of a rigidbody along its displacement, against the other colliders of the scene.
+	/// </summary>
+	/// <param name="body">The moving rigidbody</param>
+	/// <param name="displacement">The world space displacement of the step</param>
+	/// <param name="colliders">The colliders of the scene</param>
+	/// <param name="normal">The normal of the first impact, toward the body</param>
+	/// <returns>The fraction of the displacement before the first impact, 1 if none</returns>
+	float TimeOfImpact(Rigidbody* body, glm::vec3 displacement, const std::vector<ICollider*>& colliders, glm::vec3& normal) {
+		float toi = 1.0f;
+		std::vector<ICollider*> own = body->attachment->getComponentsByType<ICollider>();
+		for (size_t i = 0, max = own.size(); i < max; i++) {
+			if (own[i]->IsTrigger()) {
+				continue;
+			}
+			for (size_t j = 0, maxJ = colliders.size(); j < maxJ; j++) {
+				ICollider* other = colliders[j];
+				if (other->attachment == body->attachment || other->IsTrigger() || !IsPhysicsBetweenLayers(body->attachment->GetLayer(), other->attachment->GetLayer())) {
+					continue;
+				}
+				glm::vec3 n;
+				double t = CollisionDetection::TimeOfImpact(own[i], displacement, other, n);
+				if (t >= 0.0 && t < toi) {
+					toi = (float)t;
+					normal = n;
+				}
+			}
+		}
+		return toi;
+	}
 };
 
 #endif
\ No newline at end of file
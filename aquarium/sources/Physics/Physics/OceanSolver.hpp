@@ -0,0 +1,454 @@
+#ifndef __OCEAN_SOLVER_HPP__
+#define __OCEAN_SOLVER_HPP__
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include <Engine/Tools/Simd.hpp>
+#include <Engine/Tools/JobPool.hpp>
+#include <Physics/Physics/CPhysic.hpp>
+
+/// <summary>
+/// The ocean waves on the CPU: a square periodic patch synthesized from a wave spectrum (Phillips or JONSWAP) by an inverse FFT, as in Tessendorf's "Simulating Ocean Water".
+/// The patch is periodic, so it tiles any surface at the same cost, and its waves at a time do not depend on the previous frames.
+/// The height and the two slopes are synthesized by two complex FFTs: the height and the x slope are real, so they share one transform as its real and imaginary parts.
+/// The 2D FFT is a radix-2 FFT on the columns, 8 or 4 columns at a time with AVX or SSE2 and split across the JobPool, then a transpose and the columns again.
+/// The initial spectrum is also read by the GPU path of WaterPhysics, so both paths give the same waves.
+/// </summary>
+class OceanSolver : public CPhysic {
+public:
+	/// <summary>
+	/// The spectrum of the waves.
+	/// </summary>
+	enum Spectrum {
+		PHILLIPS, // fully developed sea, the classic spectrum of Tessendorf
+		JONSWAP // sea limited by the fetch, a sharper peak
+	};
+
+	/// <summary>
+	/// The settings of the waves.
+	/// </summary>
+	struct Settings {
+		Spectrum spectrum = JONSWAP;
+		float patchSize = 8.0f; // the size of the periodic patch, in world units
+		float windSpeed = 3.0f; // the wind speed, in world units per second
+		glm::vec2 windDirection = glm::vec2(1, 0);
+		float fetch = 40.0f; // the distance over which the wind blows, for JONSWAP
+		float gamma = 3.3f; // the peak enhancement of JONSWAP
+		float amplitude = 1.0f; // the scale of the heights
+		float smallWaves = 0.0f; // the wave length under which the waves are damped, for Phillips (0 = none)
+		unsigned int seed = 1; // the seed of the random phases
+
+		Settings() {}
+	};
+
+	static constexpr float GRAVITY = 9.81f;
+
+protected:
+	int size; // the resolution of the patch, a power of two
+	int logSize;
+	Settings settings;
+
+	//The initial spectrum h0(k) and conj(h0(-k)), interleaved (re, im, re, im) per wave vector, row by row.
+	std::vector<float> spectrum;
+
+	//The frequency spectrum then the synthesized patch: a = height + i slope x, b = slope z. Transposed after the FFT.
+	std::vector<float> aRe, aIm, bRe, bIm;
+	//The transpose destination.
+	std::vector<float> tRe, tIm, uRe, uIm;
+
+	std::vector<float> twiddleRe, twiddleIm; // e^(2 pi i k / size), k < size / 2
+	std::vector<int> reversed; // the bit reversal of the indices
+
+	double time = 0.0;
+
+	//Number of columns given to a thread, a multiple of the SIMD width.
+	size_t columnsPerChunk = 32;
+
+	JobPool* pool = JobPool::Main();
+
+public:
+	/// <summary>
+	/// Create the ocean solver, and generate its spectrum.
+	/// </summary>
+	/// <param name="size">The resolution of the patch, rounded up to a power of two</param>
+	/// <param name="settings">The settings of the waves</param>
+	OceanSolver(int size = 128, Settings settings = Settings()) : CPhysic(true) {
+		this->logSize = 1;
+		while ((1 << this->logSize) < size) {
+			this->logSize++;
+		}
+		this->size = 1 << this->logSize;
+
+		size_t count = (size_t)this->size * (size_t)this->size;
+		for (std::vector<float>* a : { &aRe, &aIm, &bRe, &bIm, &tRe, &tIm, &uRe, &uIm }) {
+			a->assign(count, 0.0f);
+		}
+
+		const double PI = 3.14159265358979323846;
+		this->twiddleRe.resize(this->size / 2);
+		this->twiddleIm.resize(this->size / 2);
+		for (int k = 0; k < this->size / 2; k++) {
+			this->twiddleRe[k] = (float)cos(2.0 * PI * k / this->size);
+			this->twiddleIm[k] = (float)sin(2.0 * PI * k / this->size);
+		}
+		this->reversed.resize(this->size);
+		for (int i = 0; i < this->size; i++) {
+			int r = 0;
+			for (int b = 0; b < this->logSize; b++) {
+				r |= ((i >> b) & 1) << (this->logSize - 1 - b);
+			}
+			this->reversed[i] = r;
+		}
+
+		SetSettings(settings);
+	}
+
+	/// <summary>
+	/// Set the settings of the waves, and generate the spectrum again.
+	/// </summary>
+	/// <param name="settings">The settings</param>
+	void SetSettings(Settings settings) {
+		this->settings = settings;
+		GenerateSpectrum();
+	}
+
+	/// <summary>
+	/// Set the job pool splitting the columns.
+	/// </summary>
+	/// <param name="pool">The job pool, nullptr to compute on the calling thread</param>
+	void SetJobPool(JobPool* pool) {
+		this->pool = pool;
+	}
+
+	/// <summary>
+	/// Advance the time, and synthesize the patch.
+	/// </summary>
+	/// <param name="delta">Time since last frame</param>
+	void Compute(double delta) override {
+		this->time += delta;
+		Synthesize((float)this->time);
+	}
+
+	/// <summary>
+	/// Synthesize the patch at a time: the spectrum at this time, then the inverse FFT.
+	/// </summary>
+	/// <param name="t">The time, in seconds</param>
+	void Synthesize(float t) {
+		Evolve(t);
+		FFT();
+	}
+
+	/// <summary>
+	/// Return the height of a texel of the patch.
+	/// </summary>
+	/// <param name="x">The column, wrapped</param>
+	/// <param name="y">The row, wrapped</param>
+	/// <returns>The height</returns>
+	float GetHeight(int x, int y) {
+		return this->aRe[Transposed(x, y)];
+	}
+
+	/// <summary>
+	/// Return the slope of a texel of the patch, the derivatives of the height along x and z.
+	/// </summary>
+	/// <param name="x">The column, wrapped</param>
+	/// <param name="y">The row, wrapped</param>
+	/// <returns>The slope</returns>
+	glm::vec2 GetSlope(int x, int y) {
+		size_t i = Transposed(x, y);
+		return glm::vec2(this->aIm[i], this->bRe[i]);
+	}
+
+	/// <summary>
+	/// Write the patch in the layout of the GPU texture (RGBA, row by row): height, slope x, slope z, 0.
+	/// </summary>
+	/// <param name="rgba">The destination, resized</param>
+	void GetPatch(std::vector<float>& rgba) {
+		size_t n = (size_t)this->size;
+		rgba.resize(n * n * 4);
+		for (size_t y = 0; y < n; y++) {
+			for (size_t x = 0; x < n; x++) {
+				size_t i = x * n + y;
+				float* p = &rgba[(y * n + x) * 4];
+				p[0] = this->aRe[i];
+				p[1] = this->aIm[i];
+				p[2] = this->bRe[i];
+				p[3] = 0.0f;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Return the initial spectrum, h0(k) and conj(h0(-k)) per wave vector (RGBA, row by row), for the GPU path.
+	/// </summary>
+	/// <returns>The spectrum</returns>
+	const std::vector<float>& GetSpectrum() {
+		return this->spectrum;
+	}
+
+	/// <summary>
+	/// Return the settings of the waves.
+	/// </summary>
+	/// <returns>The settings</returns>
+	const Settings& GetSettings() {
+		return this->settings;
+	}
+
+	/// <summary>
+	/// Return the resolution of the patch.
+	/// </summary>
+	/// <returns>The resolution, a power of two</returns>
+	int GetSize() {
+		return this->size;
+	}
+
+	/// <summary>
+	/// Return the time of the waves.
+	/// </summary>
+	/// <returns>The time, in seconds</returns>
+	double GetTime() {
+		return this->time;
+	}
+
+protected:
+
+	size_t Transposed(int x, int y) {
+		x &= this->size - 1;
+		y &= this->size - 1;
+		return (size_t)x * (size_t)this->size + (size_t)y;
+	}
+
+	/// <summary>
+	/// Return the wave vector of an index of the spectrum, the upper half of the indices are the negative frequencies.
+	/// </summary>
+	glm::vec2 WaveVector(int x, int y) {
+		const float PI = 3.14159265f;
+		int n = x < this->size / 2 ? x : x - this->size;
+		int m = y < this->size / 2 ? y : y - this->size;
+		return glm::vec2((float)n, (float)m) * (2.0f * PI / this->settings.patchSize);
+	}
+
+	/// <summary>
+	/// Return the energy of the waves of a wave vector, per unit of wave vector area.
+	/// </summary>
+	float Energy(glm::vec2 k) {
+		const float PI = 3.14159265f;
+		float length = glm::length(k);
+		if (length < 1e-6f) {
+			return 0.0f;
+		}
+		glm::vec2 wind = glm::length(this->settings.windDirection) > 0.0f ? glm::normalize(this->settings.windDirection) : glm::vec2(1, 0);
+		float cosine = glm::dot(k / length, wind);
+		float windSpeed = std::max(this->settings.windSpeed, 0.01f);
+
+		if (this->settings.spectrum == PHILLIPS) {
+			float L = windSpeed * windSpeed / GRAVITY; // the largest wave from the wind
+			float e = 0.0081f / (2.0f * PI) * expf(-1.0f / (length * length * L * L)) / powf(length, 4.0f) * cosine * cosine;
+			if (this->settings.smallWaves > 0.0f) {
+				e *= expf(-length * length * this->settings.smallWaves * this->settings.smallWaves);
+			}
+			return e;
+		}
+
+		//JONSWAP in angular frequency, converted to the wave vector (deep water, omega^2 = g k), spread by cos^2 around the wind.
+		if (cosine <= 0.0f) {
+			return 0.0f;
+		}
+		float fetch = std::max(this->settings.fetch, 0.01f);
+		float omega = sqrtf(GRAVITY * length);
+		float peak = 22.0f * powf(GRAVITY * GRAVITY / (windSpeed * fetch), 1.0f / 3.0f);
+		float alpha = 0.076f * powf(windSpeed * windSpeed / (fetch * GRAVITY), 0.22f);
+		float sigma = omega <= peak ? 0.07f : 0.09f;
+		float r = expf(-(omega - peak) * (omega - peak) / (2.0f * sigma * sigma * peak * peak));
+		float s = alpha * GRAVITY * GRAVITY / powf(omega, 5.0f) * expf(-1.25f * powf(peak / omega, 4.0f)) * powf(this->settings.gamma, r);
+		float dOmega = GRAVITY / (2.0f * omega);
+		return s * dOmega / length * (2.0f / PI) * cosine * cosine;
+	}
+
+	/// <summary>
+	/// Generate the initial spectrum, gaussian random amplitudes of the energy of each wave vector.
+	/// The Nyquist frequencies are left at 0, so the synthesized fields are exactly real.
+	/// </summary>
+	void GenerateSpectrum() {
+		int n = this->size;
+		std::mt19937 random(this->settings.seed);
+		std::normal_distribution<float> gaussian(0.0f, 1.0f);
+		float dk = 2.0f * 3.14159265f / this->settings.patchSize;
+
+		std::vector<glm::vec2> h0((size_t)n * (size_t)n, glm::vec2(0));
+		for (int y = 0; y < n; y++) {
+			for (int x = 0; x < n; x++) {
+				float re = gaussian(random);
+				float im = gaussian(random);
+				if (x == n / 2 || y == n / 2) {
+					continue;
+				}
+				float amplitude = sqrtf(Energy(WaveVector(x, y)) * dk * dk * 0.5f) * this->settings.amplitude;
+				h0[(size_t)y * n + x] = glm::vec2(re, im) * amplitude;
+			}
+		}
+
+		this->spectrum.resize((size_t)n * (size_t)n * 4);
+		for (int y = 0; y < n; y++) {
+			for (int x = 0; x < n; x++) {
+				glm::vec2 h = h0[(size_t)y * n + x];
+				glm::vec2 opposite = h0[(size_t)((n - y) % n) * n + (n - x) % n];
+				float* s = &this->spectrum[((size_t)y * n + x) * 4];
+				s[0] = h.x;
+				s[1] = h.y;
+				s[2] = opposite.x;
+				s[3] = -opposite.y;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Write the spectrum at a time: h(k, t) = h0(k) e^(i w t) + conj(h0(-k)) e^(-i w t), packed with the slopes i k h(k, t).
+	/// </summary>
+	void Evolve(float t) {
+		int n = this->size;
+		for (int y = 0; y < n; y++) {
+			for (int x = 0; x < n; x++) {
+				size_t i = (size_t)y * n + x;
+				const float* s = &this->spectrum[i * 4];
+				glm::vec2 k = WaveVector(x, y);
+				float omega = sqrtf(GRAVITY * glm::length(k));
+				float c = cosf(omega * t);
+				float sn = sinf(omega * t);
+				float hRe = s[0] * c - s[1] * sn + s[2] * c + s[3] * sn;
+				float hIm = s[0] * sn + s[1] * c - s[2] * sn + s[3] * c;
+
+				//a = h + i (i kx h) = (1 - kx) h, b = i kz h.
+				this->aRe[i] = hRe * (1.0f - k.x);
+				this->aIm[i] = hIm * (1.0f - k.x);
+				this->bRe[i] = -k.y * hIm;
+				this->bIm[i] = k.y * hRe;
+			}
+		}
+	}
+
+	/// <summary>
+	/// The inverse 2D FFT of a and b: the columns, a transpose, and the columns again. The result is transposed.
+	/// </summary>
+	void FFT() {
+		Columns();
+		Transpose(this->aRe, this->tRe);
+		Transpose(this->aIm, this->tIm);
+		Transpose(this->bRe, this->uRe);
+		Transpose(this->bIm, this->uIm);
+		this->aRe.swap(this->tRe);
+		this->aIm.swap(this->tIm);
+		this->bRe.swap(this->uRe);
+		this->bIm.swap(this->uIm);
+		Columns();
+	}
+
+	/// <summary>
+	/// Transform every column of a and b, the columns split across the JobPool.
+	/// </summary>
+	void Columns() {
+		size_t columns = (size_t)this->size;
+		if (this->pool != nullptr) {
+			this->pool->ParallelFor(columns, this->columnsPerChunk, [this](size_t begin, size_t end) {
+				ColumnRange(begin, end);
+			});
+		}
+		else {
+			ColumnRange(0, columns);
+		}
+	}
+
+	/// <summary>
+	/// Transform the columns [begin, end) of a and b: the rows in bit reversed order, then the radix-2 stages.
+	/// </summary>
+	void ColumnRange(size_t begin, size_t end) {
+		size_t n = (size_t)this->size;
+		float* channels[4] = { this->aRe.data(), this->aIm.data(), this->bRe.data(), this->bIm.data() };
+		for (size_t y = 0; y < n; y++) {
+			size_t r = (size_t)this->reversed[y];
+			if (r > y) {
+				for (float* c : channels) {
+					std::swap_ranges(c + y * n + begin, c + y * n + end, c + r * n + begin);
+				}
+			}
+		}
+
+		for (size_t half = 1; half < n; half *= 2) {
+			size_t step = n / (2 * half);
+			for (size_t start = 0; start < n; start += 2 * half) {
+				for (size_t k = 0; k < half; k++) {
+					size_t top = (start + k) * n;
+					size_t bottom = top + half * n;
+					float wRe = this->twiddleRe[k * step];
+					float wIm = this->twiddleIm[k * step];
+					size_t x = begin;
+#if defined(SIMD_ENABLED)
+					for (; x + SimdLane::WIDTH <= end; x += SimdLane::WIDTH) {
+						Butterfly(SimdLane(), top + x, bottom + x, wRe, wIm);
+					}
+#endif
+					for (; x < end; x++) {
+						Butterfly(SimdScalar(), top + x, bottom + x, wRe, wIm);
+					}
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// The butterflies of Ops::WIDTH columns, on a and b: top + w bottom, top - w bottom.
+	/// </summary>
+	template<class Ops>
+	void Butterfly(Ops, size_t top, size_t bottom, float wRe, float wIm) {
+		typedef typename Ops::Reg Reg;
+		Reg cRe = Ops::Set(wRe);
+		Reg cIm = Ops::Set(wIm);
+		float* channels[2][2] = { { this->aRe.data(), this->aIm.data() }, { this->bRe.data(), this->bIm.data() } };
+		for (int c = 0; c < 2; c++) {
+			float* re = channels[c][0];
+			float* im = channels[c][1];
+			Reg topRe = Ops::Load(re + top);
+			Reg topIm = Ops::Load(im + top);
+			Reg bottomRe = Ops::Load(re + bottom);
+			Reg bottomIm = Ops::Load(im + bottom);
+			Reg productRe = Ops::Sub(Ops::Mul(bottomRe, cRe), Ops::Mul(bottomIm, cIm));
+			Reg productIm = Ops::Add(Ops::Mul(bottomRe, cIm), Ops::Mul(bottomIm, cRe));
+			Ops::Store(re + top, Ops::Add(topRe, productRe));
+			Ops::Store(im + top, Ops::Add(topIm, productIm));
+			Ops::Store(re + bottom, Ops::Sub(topRe, productRe));
+			Ops::Store(im + bottom, Ops::Sub(topIm, productIm));
+		}
+	}
+
+	/// <summary>
+	/// Transpose a channel, by blocks of 16x16 to stay in the cache, the rows of blocks split across the JobPool.
+	/// </summary>
+	void Transpose(const std::vector<float>& src, std::vector<float>& dst) {
+		const size_t BLOCK = 16;
+		size_t n = (size_t)this->size;
+		auto rows = [&src, &dst, n, BLOCK](size_t begin, size_t end) {
+			for (size_t by = begin * BLOCK; by < end * BLOCK && by < n; by += BLOCK) {
+				for (size_t bx = 0; bx < n; bx += BLOCK) {
+					for (size_t y = by, maxY = std::min(by + BLOCK, n); y < maxY; y++) {
+						for (size_t x = bx, maxX = std::min(bx + BLOCK, n); x < maxX; x++) {
+							dst[x * n + y] = src[y * n + x];
+						}
+					}
+				}
+			}
+		};
+		size_t blocks = (n + BLOCK - 1) / BLOCK;
+		if (this->pool != nullptr) {
+			this->pool->ParallelFor(blocks, 0, rows);
+		}
+		else {
+			rows(0, blocks);
+		}
+	}
+};
+
+#endif // !__OCEAN_SOLVER_HPP__
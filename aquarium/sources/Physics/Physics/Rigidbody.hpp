@@ -15,9 +15,34 @@ protected:
 	float mass = 1.0f;
 	float drag = 0.0f;
 	glm::vec3 velocity = glm::vec3(0);
+
+	//Rotation speed on each axis, in degrees per second (euler angles as the Transformation).
+	glm::vec3 angularVelocity = glm::vec3(0);
 	glm::vec3 acceleration = glm::vec3(0);
 	bool gravity = false;
 
+	//Forces added since the last step.
+	glm::vec3 force = glm::vec3(0);
+
+	//Sleep state, a body slower than sleepVelocity and sleepAngularVelocity during sleepTime seconds stop being computed.
+	bool sleeping = false;
+	float sleepTimer = 0.0f;
+	float sleepVelocity = 0.01f;
+	float sleepAngularVelocity = 1.0f;
+	float sleepTime = 0.5f;
+
+	//Transformation version when the body fell asleep, an edit of the transformation wakes it up.
+	uint64_t sleepVersion = 0;
+
+	//Island of the body in the last contact solver step, -1 if not touching another body.
+	int island = -1;
+
+	//Was the body touching another one at the beginning of the current step.
+	bool touching = false;
+
+	//Continuous collision detection, the move of the body is swept against the colliders to not pass through them.
+	bool ccd = false;
+
 public:
 
 	/// <summary>
@@ -32,12 +57,70 @@ public:
 		this->gravity = gravity;
 	}
 
+	/// <summary>
+	/// Return the default gravity acceleration, in world space.
+	/// </summary>
+	/// <returns>The gravity</returns>
+	static glm::vec3 DefaultGravity() {
+		return glm::vec3(0, -9.81f, 0);
+	}
+
 	/// <summary>
 	/// Set the velocity of the object.
 	/// </summary>
 	/// <param name="velocity">The new velocity</param>
 	void SetVelocity(glm::vec3 velocity) {
 		this->velocity = velocity;
+		WakeUp();
+	}
+
+	/// <summary>
+	/// Set the angular velocity of the object.
+	/// </summary>
+	/// <param name="angularVelocity">The new angular velocity, in degrees per second on each axis</param>
+	void SetAngularVelocity(glm::vec3 angularVelocity) {
+		this->angularVelocity = angularVelocity;
+		WakeUp();
+	}
+
+	/// <summary>
+	/// Return the angular velocity of the object.
+	/// </summary>
+	/// <returns>The angular velocity, in degrees per second on each axis</returns>
+	glm::vec3 GetAngularVelocity() {
+		return this->angularVelocity;
+	}
+
+	/// <summary>
+	/// Set the velocity computed by the contact solver, without waking the body up.
+	/// </summary>
+	/// <param name="velocity">The new velocity</param>
+	void ApplySolverVelocity(glm::vec3 velocity) {
+		this->velocity = velocity;
+	}
+
+	/// <summary>
+	/// Return the mass of the object, 0 for a static object.
+	/// </summary>
+	/// <returns>The mass</returns>
+	float GetMass() {
+		return this->mass;
+	}
+
+	/// <summary>
+	/// Return the inverse of the mass, 0 for a static object.
+	/// </summary>
+	/// <returns>The inverse mass</returns>
+	float GetInverseMass() {
+		return this->mass > 0.0f ? 1.0f / this->mass : 0.0f;
+	}
+
+	/// <summary>
+	/// Return if the object is moved by the forces and the contacts (mass greater than 0).
+	/// </summary>
+	/// <returns>Is dynamic ?</returns>
+	bool IsDynamic() {
+		return this->mass > 0.0f;
 	}
 
 	/// <summary>
@@ -64,6 +147,38 @@ public:
 		return this->acceleration;
 	}
 
+	/// <summary>
+	/// Return the drag of the object, the fraction of velocity lost per second is drag / (1 + drag).
+	/// </summary>
+	/// <returns>The drag</returns>
+	float GetDrag() {
+		return this->drag;
+	}
+
+	/// <summary>
+	/// Return the forces added since the last step.
+	/// </summary>
+	/// <returns>The force</returns>
+	glm::vec3 GetForce() {
+		return this->force;
+	}
+
+	/// <summary>
+	/// Enable the continuous collision detection, for fast objects that could pass through thin colliders in one step.
+	/// </summary>
+	/// <param name="ccd">Is continuous ?</param>
+	void SetCCD(bool ccd) {
+		this->ccd = ccd;
+	}
+
+	/// <summary>
+	/// Return if the continuous collision detection is enabled.
+	/// </summary>
+	/// <returns>Is continuous ?</returns>
+	bool IsCCD() {
+		return this->ccd;
+	}
+
 	/// <summary>
 	/// Return if is gravity
 	/// </summary>
@@ -73,28 +188,176 @@ public:
 	}
 
 	/// <summary>
-	/// Create an impulse on the object (not implemented yet)
+	/// Create an impulse on the object, change instantly the velocity.
 	/// </summary>
 	/// <param name="impulse">The impulse</param>
 	void Impulse(glm::vec3 impulse) {
-
+		this->velocity += impulse * GetInverseMass();
+		WakeUp();
 	}
 
 
 	/// <summary>
-	/// Create an force on the object (not implemented yet)
+	/// Create an force on the object, applied on the next step.
 	/// </summary>
 	/// <param name="force">The force</param>
 	void AddForce(glm::vec3 force) {
+		this->force += force;
+		WakeUp();
+	}
+
+	/// <summary>
+	/// Return if the object is sleeping.
+	/// </summary>
+	/// <returns>Is sleeping ?</returns>
+	bool IsSleeping() {
+		return this->sleeping;
+	}
+
+	/// <summary>
+	/// Put the object to sleep, it stop moving until woken up.
+	/// </summary>
+	void Sleep() {
+		this->sleeping = true;
+		this->velocity = glm::vec3(0);
+		this->angularVelocity = glm::vec3(0);
+		this->force = glm::vec3(0);
+		if (this->attachment != nullptr) {
+			this->sleepVersion = this->attachment->GetTransform()->GetVersion();
+		}
+	}
+
+	/// <summary>
+	/// Wake the object up.
+	/// </summary>
+	void WakeUp() {
+		this->sleeping = false;
+		this->sleepTimer = 0.0f;
+	}
+
+	/// <summary>
+	/// Set the thresholds under which the object fall asleep.
+	/// </summary>
+	/// <param name="velocity">The linear speed</param>
+	/// <param name="angularVelocity">The angular speed, in degrees per second</param>
+	/// <param name="time">The time the object must stay under both speeds, in seconds</param>
+	void SetSleepThresholds(float velocity, float angularVelocity, float time) {
+		this->sleepVelocity = velocity;
+		this->sleepAngularVelocity = angularVelocity;
+		this->sleepTime = time;
+	}
 
+	/// <summary>
+	/// Return the time the object spent under the sleep velocity.
+	/// </summary>
+	/// <returns>The time in seconds</returns>
+	float GetSleepTimer() {
+		return this->sleepTimer;
+	}
+
+	/// <summary>
+	/// Return if the object was slow long enough to sleep.
+	/// </summary>
+	/// <returns>Can sleep ?</returns>
+	bool CanSleep() {
+		return this->sleepTimer >= this->sleepTime;
+	}
+
+	/// <summary>
+	/// Set the island of the object, used by the contact solver.
+	/// </summary>
+	/// <param name="island">The island index, -1 if none.</param>
+	void SetIsland(int island) {
+		this->island = island;
+	}
+
+	/// <summary>
+	/// Return the island of the object in the last contact solver step.
+	/// </summary>
+	/// <returns>The island index, -1 if none.</returns>
+	int GetIsland() {
+		return this->island;
+	}
+
+	/// <summary>
+	/// Begin an integration step, must be followed by EndStep if the body is awake.
+	/// A sleeping body is woken up if its transformation was edited since it fell asleep.
+	/// </summary>
+	/// <returns>Is the body integrated on this step ?</returns>
+	bool BeginStep() {
+		//The island is set again by the contact solver if the body still touch another one.
+		this->touching = this->island >= 0;
+		this->island = -1;
+		if (this->sleeping && this->attachment->GetTransform()->GetVersion() != this->sleepVersion) {
+			WakeUp();
+		}
+		return !this->sleeping;
+	}
+
+	/// <summary>
+	/// Return the acceleration of the step, without the forces.
+	/// </summary>
+	/// <param name="gravity">The gravity of the world, applied if gravity is enabled.</param>
+	/// <returns>The acceleration</returns>
+	glm::vec3 GetStepAcceleration(glm::vec3 gravity) {
+		return (this->gravity && IsDynamic()) ? this->acceleration + gravity : this->acceleration;
+	}
+
+	/// <summary>
+	/// End an integration step with the integrated values.
+	/// </summary>
+	/// <param name="displacement">The world space displacement of the step.</param>
+	/// <param name="velocity">The velocity for the next step.</param>
+	/// <param name="speed">The speed the body moved with during the step.</param>
+	/// <param name="rotation">The rotation of the step, in degrees on each axis.</param>
+	/// <param name="angularVelocity">The angular velocity for the next step.</param>
+	/// <param name="angularSpeed">The angular speed the body rotated with during the step.</param>
+	/// <param name="delta">Time of the step.</param>
+	void EndStep(glm::vec3 displacement, glm::vec3 velocity, float speed, glm::vec3 rotation, glm::vec3 angularVelocity, float angularSpeed, float delta) {
+		//The integration is in world space, the displacement is brought back in the space of the parent.
+		Transformation* t = this->attachment->GetTransform();
+		if (displacement != glm::vec3(0)) {
+			GameObject* parent = this->attachment->getParent();
+			if (parent != nullptr) {
+				displacement = glm::inverse(glm::mat3(parent->GetMatrixRecursive())) * displacement;
+			}
+			t->SetPosition(t->getPosition() + displacement);
+		}
+		if (rotation != glm::vec3(0)) {
+			t->Rotate(rotation);
+		}
+
+		if (speed < this->sleepVelocity && angularSpeed < this->sleepAngularVelocity) {
+			this->sleepTimer += delta;
+		}
+		else {
+			this->sleepTimer = 0.0f;
+		}
+
+		//A body touching others sleep with its whole island, decided by the contact solver.
+		if (!this->touching && CanSleep()) {
+			Sleep();
+			return;
+		}
+
+		this->velocity = velocity;
+		this->angularVelocity = angularVelocity;
+		this->force = glm::vec3(0);
 	}
 
 	/// <summary>
-	/// Compute the physic.
+	/// Compute the physic alone, the Physics engine integrate every rigidbody at once with the Integrator.
 	/// </summary>
 	/// <param name="delta">Time since last frame.</param>
 	void Compute(double delta) override {
-		this->attachment->GetTransform()->Translate(this->velocity * (float)delta);
+		if (!BeginStep()) {
+			return;
+		}
+		float dt = (float)delta;
+		glm::vec3 a = GetStepAcceleration(DefaultGravity()) + this->force * GetInverseMass();
+		float damping = 1.0f / (1.0f + this->drag * dt);
+		glm::vec3 v = (this->velocity + a * dt) * damping;
+		EndStep(this->velocity * dt, v, glm::length(this->velocity), this->angularVelocity * dt, this->angularVelocity * damping, glm::length(this->angularVelocity), dt);
 	}
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,292 @@
+#ifndef __WATER_SOLVER_HPP__
+#define __WATER_SOLVER_HPP__
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+
+#include <Engine/Tools/Simd.hpp>
+#include <Engine/Tools/JobPool.hpp>
+#include <Physics/Physics/CPhysic.hpp>
+
+/// <summary>
+/// The water ripples on the CPU, the same heightfield update as Physics/water.frag and Physics/drop.frag.
+/// The state is kept in SoA float arrays (height, velocity, normal x, normal z, the r, g, b, a channels of the GPU texture) and double buffered.
+/// Each step is split by rows across the JobPool, and each row is computed 8 by 8 with AVX or 4 by 4 with SSE2.
+/// Used without OpenGL (headless), to read the heights on the CPU, or as a reference for the GPU path.
+/// </summary>
+class WaterSolver : public CPhysic {
+protected:
+	/// <summary>
+	/// Data of a drop of water, in texture coordinates.
+	/// </summary>
+	struct Drop {
+		glm::vec2 pos;
+		float radius;
+		float strength;
+	};
+
+	int resolutionX, resolutionY; // the resolution of the heightfield
+	float invResX, invResY; // inverse of the resolution
+
+	//Current state, read by the step.
+	std::vector<float> height, velocity, normalX, normalZ;
+	//Next state, written by the step then swapped.
+	std::vector<float> nextHeight, nextVelocity, nextNormalX, nextNormalZ;
+
+	std::vector<Drop> drops; // list of drops to apply
+
+	//Number of rows given to a thread.
+	size_t rowsPerChunk = 16;
+
+	JobPool* pool = JobPool::Main();
+
+public:
+	/// <summary>
+	/// Create the water solver, flat water at rest.
+	/// </summary>
+	/// <param name="resolutionX">The width of the heightfield</param>
+	/// <param name="resolutionY">The height of the heightfield</param>
+	WaterSolver(int resolutionX = 1024, int resolutionY = 1024) : CPhysic(true) {
+		this->resolutionX = resolutionX;
+		this->resolutionY = resolutionY;
+		this->invResX = 1.0f / (float)resolutionX;
+		this->invResY = 1.0f / (float)resolutionY;
+
+		size_t size = (size_t)resolutionX * (size_t)resolutionY;
+		for (std::vector<float>* a : { &height, &velocity, &normalX, &normalZ, &nextHeight, &nextVelocity, &nextNormalX, &nextNormalZ }) {
+			a->assign(size, 0.0f);
+		}
+	}
+
+	/// <summary>
+	/// Set the job pool splitting the rows.
+	/// </summary>
+	/// <param name="pool">The job pool, nullptr to compute on the calling thread</param>
+	void SetJobPool(JobPool* pool) {
+		this->pool = pool;
+	}
+
+	/// <summary>
+	/// Add a drop to the water, applied on the next step with every other queued drop, like the GPU path.
+	/// </summary>
+	/// <param name="pos">The position of the drop, in texture coordinates</param>
+	/// <param name="radius">The radius of the drop, in texture coordinates</param>
+	/// <param name="strength">The power of the drop</param>
+	void AddDrop(glm::vec2 pos, float radius, float strength) {
+		this->drops.push_back(Drop{ pos, radius, strength });
+	}
+
+	/// <summary>
+	/// Compute the physic, the queued drops then the ripples.
+	/// </summary>
+	/// <param name="delta">Time since last frame</param>
+	void Compute(double delta) override {
+		for (const Drop& drop : this->drops) {
+			ApplyDrop(drop);
+		}
+		this->drops.clear();
+		Step((float)delta);
+	}
+
+	/// <summary>
+	/// Move the ripples of one step.
+	/// </summary>
+	/// <param name="delta">Time of the step</param>
+	void Step(float delta) {
+		size_t rows = (size_t)this->resolutionY;
+		if (this->pool != nullptr) {
+			this->pool->ParallelFor(rows, this->rowsPerChunk, [this, delta](size_t begin, size_t end) {
+				for (size_t y = begin; y < end; y++) {
+					Row((int)y, delta);
+				}
+			});
+		}
+		else {
+			for (size_t y = 0; y < rows; y++) {
+				Row((int)y, delta);
+			}
+		}
+
+		this->height.swap(this->nextHeight);
+		this->velocity.swap(this->nextVelocity);
+		this->normalX.swap(this->nextNormalX);
+		this->normalZ.swap(this->nextNormalZ);
+	}
+
+	/// <summary>
+	/// Return the height of a texel.
+	/// </summary>
+	/// <param name="x">The column, clamped to the heightfield</param>
+	/// <param name="y">The row, clamped to the heightfield</param>
+	/// <returns>The height</returns>
+	float GetHeight(int x, int y) {
+		return this->height[Index(x, y)];
+	}
+
+	/// <summary>
+	/// Return the normal of a texel, like the GPU path only x and z are stored.
+	/// </summary>
+	/// <param name="x">The column, clamped to the heightfield</param>
+	/// <param name="y">The row, clamped to the heightfield</param>
+	/// <returns>The normal</returns>
+	glm::vec3 GetNormal(int x, int y) {
+		size_t i = Index(x, y);
+		float nx = this->normalX[i];
+		float nz = this->normalZ[i];
+		return glm::vec3(nx, sqrtf(std::max(0.0f, 1.0f - nx * nx - nz * nz)), nz);
+	}
+
+	/// <summary>
+	/// Return the heights, row by row.
+	/// </summary>
+	/// <returns>The heights</returns>
+	const std::vector<float>& GetHeights() {
+		return this->height;
+	}
+
+	/// <summary>
+	/// Return the velocities, row by row.
+	/// </summary>
+	/// <returns>The velocities</returns>
+	const std::vector<float>& GetVelocities() {
+		return this->velocity;
+	}
+
+	/// <summary>
+	/// Write the state in the layout of the GPU texture (RGBA, row by row): height, velocity, normal x, normal z.
+	/// </summary>
+	/// <param name="rgba">The destination, resized</param>
+	void GetState(std::vector<float>& rgba) {
+		size_t size = this->height.size();
+		rgba.resize(size * 4);
+		for (size_t i = 0; i < size; i++) {
+			rgba[i * 4 + 0] = this->height[i];
+			rgba[i * 4 + 1] = this->velocity[i];
+			rgba[i * 4 + 2] = this->normalX[i];
+			rgba[i * 4 + 3] = this->normalZ[i];
+		}
+	}
+
+	/// <summary>
+	/// Set the state from the layout of the GPU texture (RGBA, row by row), e.g. to compare a step with the GPU path.
+	/// </summary>
+	/// <param name="rgba">The source, resolutionX * resolutionY * 4 floats</param>
+	void SetState(const float* rgba) {
+		for (size_t i = 0, max = this->height.size(); i < max; i++) {
+			this->height[i] = rgba[i * 4 + 0];
+			this->velocity[i] = rgba[i * 4 + 1];
+			this->normalX[i] = rgba[i * 4 + 2];
+			this->normalZ[i] = rgba[i * 4 + 3];
+		}
+	}
+
+	/// <summary>
+	/// Return the width of the heightfield.
+	/// </summary>
+	/// <returns>The width</returns>
+	int GetResolutionX() {
+		return this->resolutionX;
+	}
+
+	/// <summary>
+	/// Return the height of the heightfield.
+	/// </summary>
+	/// <returns>The height</returns>
+	int GetResolutionY() {
+		return this->resolutionY;
+	}
+
+protected:
+
+	size_t Index(int x, int y) {
+		x = std::min(std::max(x, 0), this->resolutionX - 1);
+		y = std::min(std::max(y, 0), this->resolutionY - 1);
+		return (size_t)y * (size_t)this->resolutionX + (size_t)x;
+	}
+
+	/// <summary>
+	/// Apply a drop, as Physics/drop.frag: a cosine bump added to the height where it is above 0.01.
+	/// </summary>
+	void ApplyDrop(const Drop& drop) {
+		const float PI = 3.141592f;
+		int x0 = std::max(0, (int)floorf((drop.pos.x - drop.radius) * this->resolutionX));
+		int x1 = std::min(this->resolutionX - 1, (int)ceilf((drop.pos.x + drop.radius) * this->resolutionX));
+		int y0 = std::max(0, (int)floorf((drop.pos.y - drop.radius) * this->resolutionY));
+		int y1 = std::min(this->resolutionY - 1, (int)ceilf((drop.pos.y + drop.radius) * this->resolutionY));
+
+		for (int y = y0; y <= y1; y++) {
+			for (int x = x0; x <= x1; x++) {
+				glm::vec2 coord = glm::vec2((x + 0.5f) * this->invResX, (y + 0.5f) * this->invResY);
+				float d = std::max(0.0f, 1.0f - glm::length(drop.pos - coord) / drop.radius);
+				d = 0.5f - (0.5f * cosf(d * PI));
+				if (d > 0.01f) {
+					this->height[(size_t)y * this->resolutionX + x] += d * drop.strength;
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Update a row, SIMD lanes inside the row and scalar texels on the borders (clamp to edge).
+	/// </summary>
+	void Row(int y, float delta) {
+		int w = this->resolutionX;
+		int x = 0;
+		Kernel(SimdScalar(), y, x, x, std::min(x + 1, w - 1), delta);
+		x++;
+#if defined(SIMD_ENABLED)
+		for (; x + SimdLane::WIDTH <= w - 1; x += SimdLane::WIDTH) {
+			Kernel(SimdLane(), y, x, x - 1, x + 1, delta);
+		}
+#endif
+		for (; x < w; x++) {
+			Kernel(SimdScalar(), y, x, x - 1, std::min(x + 1, w - 1), delta);
+		}
+	}
+
+	/// <summary>
+	/// Update Ops::WIDTH texels of a row from the column x, as Physics/water.frag.
+	/// </summary>
+	/// <param name="left">Column of the left neighbour of x</param>
+	/// <param name="right">Column of the right neighbour of x</param>
+	template<class Ops>
+	void Kernel(Ops, int y, int x, int left, int right, float delta) {
+		typedef typename Ops::Reg Reg;
+		size_t row = (size_t)y * (size_t)this->resolutionX;
+		size_t up = (size_t)std::max(y - 1, 0) * (size_t)this->resolutionX;
+		size_t down = (size_t)std::min(y + 1, this->resolutionY - 1) * (size_t)this->resolutionX;
+		const float* h = this->height.data();
+
+		Reg r = Ops::Load(&h[row + x]);
+		Reg g = Ops::Load(&this->velocity[row + x]);
+		Reg hLeft = Ops::Load(&h[row + left]);
+		Reg hRight = Ops::Load(&h[row + right]);
+		Reg hUp = Ops::Load(&h[up + x]);
+		Reg hDown = Ops::Load(&h[down + x]);
+
+		//Change velocity to average, attenuate it so waves do not last forever, and move the height along it.
+		Reg average = Ops::Mul(Ops::Add(Ops::Add(hLeft, hRight), Ops::Add(hUp, hDown)), Ops::Set(0.25f));
+		g = Ops::Add(g, Ops::Mul(Ops::Sub(average, r), Ops::Set(2.0f)));
+		g = Ops::Mul(g, Ops::Set(1.0f - delta * 0.1f));
+		r = Ops::Add(r, g);
+
+		//normalize(cross(ndy, ndx)).xz with ndx = (dx, right - r, 0) and ndy = (0, down - r, dy).
+		Reg c = Ops::Sub(hRight, r);
+		Reg b = Ops::Sub(hDown, r);
+		Reg dx = Ops::Set(this->invResX);
+		Reg dy = Ops::Set(this->invResY);
+		Reg nx = Ops::Mul(Ops::Mul(dy, c), Ops::Set(-1.0f));
+		Reg ny = Ops::Mul(dy, dx);
+		Reg nz = Ops::Mul(Ops::Mul(b, dx), Ops::Set(-1.0f));
+		Reg len = Ops::Sqrt(Ops::Add(Ops::Add(Ops::Mul(nx, nx), Ops::Mul(ny, ny)), Ops::Mul(nz, nz)));
+
+		Ops::Store(&this->nextHeight[row + x], r);
+		Ops::Store(&this->nextVelocity[row + x], g);
+		Ops::Store(&this->nextNormalX[row + x], Ops::Div(nx, len));
+		Ops::Store(&this->nextNormalZ[row + x], Ops::Div(nz, len));
+	}
+};
+
+#endif // !__WATER_SOLVER_HPP__
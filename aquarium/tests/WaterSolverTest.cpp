@@ -0,0 +1,141 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include <Physics/Physics/WaterSolver.hpp>
+
+//Check the WaterSolver (SIMD rows split across the JobPool) against a scalar reference of Physics/water.frag and Physics/drop.frag.
+//Return 0 if every step matches, 1 else.
+
+/// <summary>
+/// The reference heightfield, one texel at a time, RGBA row by row as the GPU texture.
+/// </summary>
+struct ReferenceWater {
+	int resolutionX, resolutionY;
+	std::vector<float> state;
+
+	ReferenceWater(int resolutionX, int resolutionY) {
+		this->resolutionX = resolutionX;
+		this->resolutionY = resolutionY;
+		this->state.assign((size_t)resolutionX * (size_t)resolutionY * 4, 0.0f);
+	}
+
+	float Height(int x, int y) {
+		x = std::min(std::max(x, 0), this->resolutionX - 1);
+		y = std::min(std::max(y, 0), this->resolutionY - 1);
+		return this->state[((size_t)y * this->resolutionX + x) * 4];
+	}
+
+	void Drop(glm::vec2 pos, float radius, float strength) {
+		for (int y = 0; y < this->resolutionY; y++) {
+			for (int x = 0; x < this->resolutionX; x++) {
+				glm::vec2 coord = glm::vec2((x + 0.5f) / this->resolutionX, (y + 0.5f) / this->resolutionY);
+				float d = std::max(0.0f, 1.0f - glm::length(pos - coord) / radius);
+				d = 0.5f - (0.5f * cosf(d * 3.141592f));
+				if (d > 0.01f) {
+					this->state[((size_t)y * this->resolutionX + x) * 4] += d * strength;
+				}
+			}
+		}
+	}
+
+	void Step(float delta) {
+		std::vector<float> next(this->state.size());
+		float dx = 1.0f / this->resolutionX;
+		float dy = 1.0f / this->resolutionY;
+		for (int y = 0; y < this->resolutionY; y++) {
+			for (int x = 0; x < this->resolutionX; x++) {
+				size_t i = ((size_t)y * this->resolutionX + x) * 4;
+				float r = this->state[i];
+				float g = this->state[i + 1];
+				float right = Height(x + 1, y);
+				float down = Height(x, y + 1);
+
+				float average = ((Height(x - 1, y) + right) + (Height(x, y - 1) + down)) * 0.25f;
+				g += (average - r) * 2.0f;
+				g *= 1.0f - delta * 0.1f;
+				r += g;
+
+				glm::vec3 normal = glm::normalize(glm::cross(glm::vec3(0.0f, down - r, dy), glm::vec3(dx, right - r, 0.0f)));
+				next[i] = r;
+				next[i + 1] = g;
+				next[i + 2] = normal.x;
+				next[i + 3] = normal.z;
+			}
+		}
+		this->state.swap(next);
+	}
+};
+
+/// <summary>
+/// Return the largest difference between two states.
+/// </summary>
+float MaxError(const std::vector<float>& a, const std::vector<float>& b) {
+	float error = 0.0f;
+	for (size_t i = 0, max = a.size(); i < max; i++) {
+		error = std::max(error, fabsf(a[i] - b[i]));
+	}
+	return error;
+}
+
+/// <summary>
+/// Run a few steps with drops on a random water, with and without the job pool, and compare them to the reference.
+/// </summary>
+bool Check(int resolutionX, int resolutionY) {
+	const float delta = 0.016f;
+	const float tolerance = 1e-4f;
+
+	std::vector<float> initial((size_t)resolutionX * (size_t)resolutionY * 4);
+	for (size_t i = 0, max = initial.size(); i < max; i++) {
+		initial[i] = (i % 4) < 2 ? 0.01f * ((float)rand() / (float)RAND_MAX - 0.5f) : 0.0f;
+	}
+
+	ReferenceWater reference(resolutionX, resolutionY);
+	reference.state = initial;
+	WaterSolver parallel(resolutionX, resolutionY);
+	parallel.SetState(initial.data());
+	WaterSolver serial(resolutionX, resolutionY);
+	serial.SetJobPool(nullptr);
+	serial.SetState(initial.data());
+
+	bool ok = true;
+	std::vector<float> parallelState, serialState;
+	for (int step = 0; step < 8 && ok; step++) {
+		if (step % 3 == 0) { // overlapping drops, added together
+			for (glm::vec3 drop : { glm::vec3(0.3f, 0.4f, 0.1f), glm::vec3(0.35f, 0.45f, 0.08f), glm::vec3(0.9f, 0.1f, 0.2f) }) {
+				reference.Drop(glm::vec2(drop), drop.z, 0.05f);
+				parallel.AddDrop(glm::vec2(drop), drop.z, 0.05f);
+				serial.AddDrop(glm::vec2(drop), drop.z, 0.05f);
+			}
+		}
+		reference.Step(delta);
+		parallel.Compute(delta);
+		serial.Compute(delta);
+
+		parallel.GetState(parallelState);
+		serial.GetState(serialState);
+		float error = MaxError(parallelState, reference.state);
+		bool deterministic = parallelState == serialState;
+		if (error > tolerance || !deterministic) {
+			printf("FAILED %dx%d step %d: error %g, job pool %s\n", resolutionX, resolutionY, step, error, deterministic ? "same" : "different");
+			ok = false;
+		}
+	}
+	if (ok) {
+		printf("OK %dx%d\n", resolutionX, resolutionY);
+	}
+	return ok;
+}
+
+int main() {
+	srand(7);
+	bool ok = true;
+	//Odd widths leave a scalar remainder after the SIMD lanes.
+	for (glm::ivec2 resolution : { glm::ivec2(1, 1), glm::ivec2(7, 5), glm::ivec2(37, 23), glm::ivec2(256, 128) }) {
+		ok = Check(resolution.x, resolution.y) && ok;
+	}
+	return ok ? 0 : 1;
+}
@@ -3,23 +3,16 @@
 const float PI = 3.141592;
 out vec4 color;
 
-in vec2 coord;
-
-uniform sampler2D tex;
-
-uniform vec2 center;
-uniform float radius;
-uniform float strength;
+in vec2 local;
+flat in float strength;
 
 void main(){
-    vec4 data = texture(tex, coord);
-    
-    //Add the drop.
-    float d = max(0.0 , 1.0 - length(center - coord) / radius);
+    //Add the drop, a cosine bump over its radius, blended additively on the height.
+    float d = max(0.0 , 1.0 - length(local));
     d = 0.5 - (0.5 * cos(d * PI));
-    if(d > 0.01){
-        data.r = d * strength;
+    if(d <= 0.01){
+        discard;
     }
-    color = data;
+    color = vec4(d * strength, 0.0, 0.0, 0.0);
 }
 
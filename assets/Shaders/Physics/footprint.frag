@@ -0,0 +1,37 @@
+#version 430
+
+out vec4 color;
+
+in vec2 world;
+flat in vec4 current;
+flat in vec4 previous;
+flat in vec3 extent;
+
+// The thickness of the collider under the surface at rest, in the water column of this texel.
+float Submerged(vec3 center){
+    vec2 d = world - center.xz;
+    float halfHeight;
+    if (current.w == 0.0) {
+        float chord = extent.x * extent.x - dot(d, d);
+        if (chord <= 0.0) {
+            return 0.0;
+        }
+        halfHeight = sqrt(chord);
+    }
+    else {
+        if (any(greaterThan(abs(d), extent.xz))) {
+            return 0.0;
+        }
+        halfHeight = extent.y;
+    }
+    return max(0.0, min(0.0, center.y + halfHeight) - (center.y - halfHeight));
+}
+
+void main(){
+    //The water pushed away by the move: lowered where the collider enters, raised back where it leaves.
+    float displaced = Submerged(previous.xyz) - Submerged(current.xyz);
+    if (displaced == 0.0) {
+        discard;
+    }
+    color = vec4(displaced * previous.w, 0.0, 0.0, 0.0);
+}
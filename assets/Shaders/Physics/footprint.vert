@@ -0,0 +1,29 @@
+#version 430
+
+// The footprint of a moving collider on the water, a quad covering its previous and its current position.
+// Positions and sizes in world units, relative to the water center at rest.
+layout(location = 0) in vec2 aCorner;
+layout(location = 1) in vec4 aCurrent; // center, shape (0 = sphere, 1 = box)
+layout(location = 2) in vec4 aPrevious; // center, strength
+layout(location = 3) in vec4 aExtent; // radius of the sphere or half size of the box
+
+uniform vec2 containerSize;
+uniform vec2 texel; // size of a texel of the water, the quad is widened by one to cover the small footprints
+
+out vec2 world;
+flat out vec4 current;
+flat out vec4 previous;
+flat out vec3 extent;
+
+void main(){
+	current = aCurrent;
+	previous = aPrevious;
+	extent = aExtent.xyz;
+
+	vec2 low = min(aCurrent.xz, aPrevious.xz) - aExtent.xz - texel;
+	vec2 high = max(aCurrent.xz, aPrevious.xz) + aExtent.xz + texel;
+	world = mix(low, high, aCorner * 0.5 + 0.5);
+
+	vec2 coord = world / containerSize + 0.5;
+	gl_Position = vec4(coord * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,13 @@
+// The normal of the water, included by the shaders reading the water state (see Shader::IncludeFiles).
+uniform int u_physics_derived_normals;
+
+// The normal of the water at a texture coordinate of state d: stored in the state, or derived from the heights of a compact state (as the step).
+vec3 PhysicsNormal(sampler2D state, vec2 coord, vec4 d){
+	if (u_physics_derived_normals == 1) {
+		vec2 texel = 1.0 / vec2(textureSize(state, 0));
+		float dx = textureLod(state, coord + vec2(texel.x, 0.0), 0.0).r - d.r;
+		float dz = textureLod(state, coord + vec2(0.0, texel.y), 0.0).r - d.r;
+		return normalize(vec3(-dx / texel.x, 1.0, -dz / texel.y));
+	}
+	return vec3(d.b, sqrt(max(0.0, 1.0 - dot(d.ba, d.ba))), d.a);
+}
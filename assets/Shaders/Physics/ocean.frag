@@ -0,0 +1,17 @@
+#version 430
+
+// Tile the ocean patch (height, slope x, slope z) over the water, as the state of the ripples: height, velocity, normal.
+out vec4 color;
+
+in vec2 coord;
+
+uniform sampler2D waves; // the patch, periodic, repeated
+uniform vec2 tiling; // the number of patches over the water
+uniform vec2 slopeScale; // the size of the water, the normals are in texture space as the ripples
+
+void main(){
+    vec4 p = texture(waves, coord * tiling);
+    vec2 slope = p.gb * slopeScale;
+    vec3 normal = normalize(vec3(-slope.x, 1.0, -slope.y));
+    color = vec4(p.r, 0.0, normal.xz);
+}
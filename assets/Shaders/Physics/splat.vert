@@ -0,0 +1,14 @@
+#version 430
+
+layout(location = 0) in vec2 aCorner;
+layout(location = 1) in vec4 aDrop; // center (texture coordinates), radius, strength
+
+out vec2 local;
+flat out float strength;
+
+void main(){
+	local = aCorner;
+	strength = aDrop.w;
+	vec2 coord = aDrop.xy + aCorner * aDrop.z;
+	gl_Position = vec4(coord * 2.0 - 1.0, 0.0, 1.0);
+}
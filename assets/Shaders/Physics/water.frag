@@ -2,17 +2,28 @@
 
 const float PI = 3.141592;
 
+// Compact state (RG16F): only the height and the velocity, the render shaders derive the normals.
+#define COMPACT 0
+
 out vec4 color;
 
 in vec2 coord;
 
 uniform sampler2D tex;
+uniform sampler2D displacement; // the footprints of the moving colliders, added to the height before the step
+uniform int useDisplacement;
 
 uniform float deltaTime;
 uniform vec2 deltaMove;
 
+// The height of the water at a texture coordinate, with the footprints.
+float Height(vec2 c){
+    return texture(tex, c).r + (useDisplacement == 1 ? texture(displacement, c).r : 0.0);
+}
+
 void main(){
     vec4 data = texture(tex, coord);
+    data.r = Height(coord);
 
 
     vec2 dx = vec2(deltaMove.x, 0.0);
@@ -20,10 +31,10 @@ void main(){
 
 
     float average = (
-        texture(tex, coord - dx).r +
-        texture(tex, coord - dy).r +
-        texture(tex, coord + dx).r +
-        texture(tex, coord + dy).r
+        Height(coord - dx) +
+        Height(coord - dy) +
+        Height(coord + dx) +
+        Height(coord + dy)
     ) * 0.25;
 
     // change velocity to average
@@ -35,9 +46,11 @@ void main(){
     // move the vertex along the velocity 
     data.r += data.g;
 
-    vec3 ndx = vec3(deltaMove.x, texture(tex, vec2(coord.x + deltaMove.x, coord.y)).r - data.r, 0.0);
-    vec3 ndy = vec3(0.0, texture(tex, vec2(coord.x, coord.y + deltaMove.y)).r - data.r, deltaMove.y);
+#if !COMPACT
+    vec3 ndx = vec3(deltaMove.x, Height(vec2(coord.x + deltaMove.x, coord.y)) - data.r, 0.0);
+    vec3 ndy = vec3(0.0, Height(vec2(coord.x, coord.y + deltaMove.y)) - data.r, deltaMove.y);
     data.ba = normalize(cross(ndy, ndx)).xz;
+#endif
 
     color = data;
 }
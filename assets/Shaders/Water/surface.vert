@@ -0,0 +1,16 @@
+#version 430
+
+// The corners of the coarse patches, subdivided by surface.tess.control and displaced by surface.tess.eval.
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+layout(location = 2) in vec2 aTexCoord;
+
+out vec3 vPos;
+out vec3 vNormal;
+out vec2 vTexCoord;
+
+void main(){
+	vPos = aPos;
+	vNormal = aNormal;
+	vTexCoord = aTexCoord;
+}
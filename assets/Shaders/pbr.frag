@@ -66,6 +66,8 @@ uniform sampler2D t_pre_normal;
 
 uniform int u_use_caustics;
 uniform sampler2D t_caustics;
+uniform sampler2D t_caustics_previous;
+uniform float u_caustics_blend; // the caustics are updated every few frames, blended from the previous to the latest
 
 // --- PBR Functions --- 
 vec3 getNormalFromMap()
@@ -221,7 +223,7 @@ void main(){
 	}
 
 	if(u_use_caustics == 1){
-		vec4 tmp = texture(t_caustics, TexCoord);
-		gAlbedo =mix(gAlbedo, vec4(tmp.xyz, 1.0f), 0.5);
+		float tmp = mix(texture(t_caustics_previous, TexCoord).r, texture(t_caustics, TexCoord).r, u_caustics_blend);
+		gAlbedo =mix(gAlbedo, vec4(vec3(tmp), 1.0f), 0.5);
 	}
 }
\ No newline at end of file
@@ -26,6 +26,8 @@ out float fogDistance;
 const float displacementFactor = 0.1f;
 const float displacementBias = 0.0f;
 
+#include "Physics/normal.glsl"
+
 void main(){
 	IsDataPhysics = u_is_data_physics;
 	float height = texture(m_heightmap, aTexCoord).r;;
@@ -33,7 +35,7 @@ void main(){
 	if(u_is_data_physics == 1 && aNormal.y == 1){
 		vec4 d = texture(p_data_physics, aTexCoord);
 		height += d.r;
-		PhysicsNorm = vec3(d.b, sqrt(1.0 - dot(d.ba, d.ba)), d.a);
+		PhysicsNorm = PhysicsNormal(p_data_physics, aTexCoord, d);
 	}
 
 	PointCoord = u_model * vec4(aPos.x, aPos.y + height, aPos.z, 1.0f);